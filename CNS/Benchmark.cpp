@@ -0,0 +1,248 @@
+// Micro-benchmarks for every cipher in Practical_1.cpp, Practical_2.cpp and
+// RSAalgo.cpp.
+//
+// Build: g++ -O2 -std=c++17 -pthread Benchmark.cpp -o Benchmark.exe
+// Usage: Benchmark.exe [--filter NAME] [--min-size SIZE] [--max-size SIZE]
+//                      [--format table|csv|json] [--min-time SECONDS]
+//
+// Each cipher runs over random text from --min-size to --max-size bytes
+// (default 1K..16M, up to 1G; sizes step by 4x and accept K/M/G suffixes).
+// A size is repeated until --min-time has elapsed. Results are MB/s, ns/byte
+// and heap allocations per call; csv/json print one machine-readable record
+// per (cipher, size). --filter keeps ciphers whose name contains NAME.
+// "-buf" entries use the allocation-free buffer API and "-key" entries a
+// prepared key object built once. Columnar plan cache counters and RSA
+// multiplications per exponentiation are printed to stderr at the end.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <new>
+
+#define CNS_NO_MAIN
+#include "Practical_1.cpp"
+#include "Practical_2.cpp"
+#include "RSAalgo.cpp"
+
+static atomic<uint64_t> allocationCount(0);
+
+// Counting allocator. noinline keeps GCC from pairing the inlined malloc
+// with the free in operator delete and warning about a mismatch.
+__attribute__((noinline)) void *operator new(size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+
+struct BenchCase {
+    string name;
+    // Runs the cipher once over `in`; `out` is a buffer of BENCH_OUT_SLACK
+    // times the input size for the -buf variants.
+    function<void(const string &in, vector<char> &out)> run;
+};
+
+static const size_t BENCH_OUT_SLACK = 2;
+// Once one call takes this long, larger sizes of that cipher are skipped.
+static const double BENCH_SKIP_SECONDS = 5.0;
+
+// Generated on first use with a fixed seed, so runs are comparable.
+static const RsaPrivateKey<32> &rsa2048() {
+    static const RsaPrivateKey<32> key = [] {
+        mt19937_64 rng(2048);
+        return generateRsaKey<32>(2048, rng);
+    }();
+    return key;
+}
+
+static vector<BenchCase> benchCases() {
+    static const vector<vector<int>> hill2 = {{3, 3}, {2, 5}};
+    static const vector<vector<int>> hill8 = [] {
+        // Unit upper-triangular keys are always invertible mod 26.
+        vector<vector<int>> k(8, vector<int>(8, 0));
+        for (int i = 0; i < 8; i++)
+            for (int j = i; j < 8; j++) k[i][j] = i == j ? 1 : (i * 7 + j * 3) % 26;
+        return k;
+    }();
+    static const vector<int> colKey = {3, 1, 4, 2, 6, 5};
+    static const long long rsaN = 3233, rsaE = 17, rsaD = 2753;   // p = 61, q = 53
+    static const string alphabet = "QWERTYUIOPASDFGHJKLZXCVBNM";
+
+    return {
+        {"caesar-enc", [](const string &in, vector<char> &) { encipherCeaserCipher(in, 3); }},
+        {"caesar-dec", [](const string &in, vector<char> &) { decipherCeaserCipher(in, 3); }},
+        {"caesar-enc-buf", [](const string &in, vector<char> &o) { encipherCeaserCipher(string_view(in), o.data(), 3); }},
+        {"affine-enc", [](const string &in, vector<char> &) { affineCipher(in, 5, 8); }},
+        {"affine-dec", [](const string &in, vector<char> &) { affineDecipher(in, 5, 8); }},
+        {"affine-enc-buf", [](const string &in, vector<char> &o) { affineCipher(string_view(in), o.data(), 5, 8); }},
+        {"substitution-enc", [](const string &in, vector<char> &) { substitutionCipher(in, alphabet); }},
+        {"substitution-dec", [](const string &in, vector<char> &) { substitutionDecipher(in, alphabet); }},
+        {"vigenere-enc", [](const string &in, vector<char> &) { encipherVinereCipher(in, "LEMON"); }},
+        {"vigenere-dec", [](const string &in, vector<char> &) { decipherVinereCipher(in, "LEMON"); }},
+        {"vigenere-enc-buf", [](const string &in, vector<char> &o) { encipherVinereCipher(string_view(in), o.data(), "LEMON"); }},
+        {"vigenere-enc-key", [](const string &in, vector<char> &o) { static const VigenereKey k("LEMON"); k.encrypt(string_view(in), o.data()); }},
+        {"vernam-enc", [](const string &in, vector<char> &) { classicVernamCipher(in, "SECRETKEY"); }},
+        {"vernam-dec", [](const string &in, vector<char> &) { classicVernamDecipher(in, "SECRETKEY"); }},
+        {"vernam-enc-buf", [](const string &in, vector<char> &o) { classicVernamCipher(string_view(in), o.data(), "SECRETKEY"); }},
+        {"playfair-enc", [](const string &in, vector<char> &) { PlayfairCipher(in, "MONARCHY"); }},
+        {"playfair-dec", [](const string &in, vector<char> &) { PlayfairDecipher(in, "MONARCHY"); }},
+        {"playfair-enc-buf", [](const string &in, vector<char> &o) { PlayfairCipher(string_view(in), o.data(), "MONARCHY"); }},
+        {"playfair-enc-key", [](const string &in, vector<char> &o) { static const PlayfairKey k("MONARCHY"); k.encrypt(string_view(in), o.data()); }},
+        {"hill2-enc", [](const string &in, vector<char> &) { HillCipher(in, hill2); }},
+        {"hill2-dec", [](const string &in, vector<char> &) { HillDecipher(in, hill2); }},
+        {"hill2-enc-buf", [](const string &in, vector<char> &o) { HillCipher(string_view(in), o.data(), hill2); }},
+        {"hill8-enc", [](const string &in, vector<char> &) { HillCipher(in, hill8); }},
+        {"hill8-dec", [](const string &in, vector<char> &) { HillDecipher(in, hill8); }},
+        {"hill8-enc-key", [](const string &in, vector<char> &o) { static const HillKey k(hill8); k.encrypt(string_view(in), o.data()); }},
+        {"hill8-dec-key", [](const string &in, vector<char> &o) { static const HillKey k(hill8); k.decrypt(string_view(in), o.data()); }},
+        {"hill8-enc-parallel", [](const string &in, vector<char> &) { HillCipherParallel(in, hill8); }},
+        {"railfence-enc", [](const string &in, vector<char> &) { railFenceCipher(in); }},
+        {"railfence-dec", [](const string &in, vector<char> &) { railFenceDecipher(in); }},
+        {"railfence-enc-buf", [](const string &in, vector<char> &o) { railFenceCipher(string_view(in), o.data()); }},
+        {"railfence7-enc", [](const string &in, vector<char> &) { railFenceCipher(in, 7, 3); }},
+        {"railfence7-dec", [](const string &in, vector<char> &) { railFenceDecipher(in, 7, 3); }},
+        {"columnar-enc", [](const string &in, vector<char> &) { singleColumnTranspositionCipher(in, colKey); }},
+        {"columnar-dec", [](const string &in, vector<char> &) { singleColumnTranspositionDecipher(in, colKey); }},
+        {"columnar-enc-buf", [](const string &in, vector<char> &o) { singleColumnTranspositionCipher(string_view(in), o.data(), colKey); }},
+        {"double-columnar-enc", [](const string &in, vector<char> &) { doubleColumnTranspositionCipher(in, colKey); }},
+        {"double-columnar-dec", [](const string &in, vector<char> &) { doubleColumnTranspositionDecipher(in, colKey); }},
+        {"double-columnar-enc-buf", [](const string &in, vector<char> &o) { doubleColumnTranspositionCipher(string_view(in), o.data(), colKey); }},
+        {"rsa-enc", [](const string &in, vector<char> &) { EncodeMode mode; rsaEncryptMessage(in, rsaE, rsaN, mode); }},
+        {"rsa-enc-packed", [](const string &in, vector<char> &) { EncodeMode mode; rsaEncryptPacked(in, rsaE, rsaN, mode); }},
+        {"rsa-dec", [](const string &in, vector<char> &) {
+            // Decrypt cost per input byte: reuse one cached ciphertext per size.
+            static string lastIn;
+            static vector<long long> cipher;
+            static EncodeMode mode;
+            if (lastIn.size() != in.size()) { lastIn = in; cipher = rsaEncryptMessage(in, rsaE, rsaN, mode); }
+            rsaDecryptMessage(cipher, rsaD, rsaN, mode);
+        }},
+        // 2048-bit key: one block per byte vs 255 bytes per block.
+        {"rsa2048-enc", [](const string &in, vector<char> &) { EncodeMode mode; rsaEncryptMessage(in, UInt2048(65537), rsa2048().n, mode); }},
+        {"rsa2048-enc-packed", [](const string &in, vector<char> &) { EncodeMode mode; rsaEncryptPacked(in, UInt2048(65537), rsa2048().n, mode); }},
+        {"rsa2048-dec-packed", [](const string &in, vector<char> &) {
+            static string lastIn;
+            static vector<UInt2048> cipher;
+            static EncodeMode mode;
+            if (lastIn.size() != in.size()) { lastIn = in; cipher = rsaEncryptPacked(in, UInt2048(65537), rsa2048().n, mode); }
+            rsaDecryptMessage(cipher, rsa2048(), mode);
+        }},
+        {"rsa2048-dec-packed-parallel", [](const string &in, vector<char> &) {
+            static string lastIn;
+            static vector<UInt2048> cipher;
+            static EncodeMode mode;
+            if (lastIn.size() != in.size()) { lastIn = in; cipher = rsaEncryptPacked(in, UInt2048(65537), rsa2048().n, mode); }
+            rsaDecryptMessageParallel(cipher, rsa2048(), mode);
+        }},
+    };
+}
+
+static size_t parseSize(const string &text) {
+    char *end = nullptr;
+    double v = strtod(text.c_str(), &end);
+    switch (end && *end ? toupper(*end) : 0) {
+        case 'K': v *= 1024; break;
+        case 'M': v *= 1024 * 1024; break;
+        case 'G': v *= 1024.0 * 1024 * 1024; break;
+    }
+    return (size_t)v;
+}
+
+static string formatSize(size_t bytes) {
+    const char *units[] = {"B", "K", "M", "G"};
+    int u = 0;
+    while (u < 3 && bytes >= 1024 && bytes % 1024 == 0) { bytes /= 1024; u++; }
+    return to_string(bytes) + units[u];
+}
+
+int main(int argc, char **argv) {
+    string filter, format = "table";
+    size_t minSize = 1024, maxSize = 16u << 20;
+    double minTime = 0.2;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) filter = argv[++i];
+        else if (arg == "--min-size" && hasValue) minSize = parseSize(argv[++i]);
+        else if (arg == "--max-size" && hasValue) maxSize = parseSize(argv[++i]);
+        else if (arg == "--format" && hasValue) format = argv[++i];
+        else if (arg == "--min-time" && hasValue) minTime = atof(argv[++i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--filter NAME] [--min-size SIZE] [--max-size SIZE]"
+                 << " [--format table|csv|json] [--min-time SECONDS]\n";
+            return 1;
+        }
+    }
+    if (minSize == 0) minSize = 1;
+
+    // Uppercase letters and spaces, so every cipher takes its normal path.
+    mt19937 rng(12345);
+    string text(maxSize, ' ');
+    for (char &ch : text) {
+        unsigned r = rng() % 32;
+        ch = r < 26 ? (char)('A' + r) : ' ';
+    }
+    vector<char> out(maxSize * BENCH_OUT_SLACK + 64);
+
+    if (format == "csv") cout << "cipher,bytes,iterations,mb_per_s,ns_per_byte,allocs_per_call\n";
+    else if (format == "table")
+        cout << left << setw(26) << "cipher" << right << setw(8) << "size" << setw(12) << "MB/s"
+             << setw(12) << "ns/byte" << setw(14) << "allocs/call" << "\n";
+
+    bool ranRsa2048 = false;
+    for (const BenchCase &bc : benchCases()) {
+        if (!filter.empty() && bc.name.find(filter) == string::npos) continue;
+        ranRsa2048 |= bc.name.compare(0, 7, "rsa2048") == 0;
+        for (size_t size = minSize; size <= maxSize; size *= 4) {
+            string in = text.substr(0, size);
+            bc.run(in, out);   // warm-up: tables, scratch buffers, caches
+
+            uint64_t iterations = 0, allocs = allocationCount.load();
+            auto t0 = chrono::steady_clock::now();
+            double elapsed = 0;
+            do {
+                bc.run(in, out);
+                iterations++;
+                elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+            } while (elapsed < minTime);
+            allocs = allocationCount.load() - allocs;
+
+            double mbps = size * iterations / elapsed / (1024.0 * 1024.0);
+            double nspb = elapsed * 1e9 / ((double)size * iterations);
+            double apc = (double)allocs / iterations;
+            if (format == "csv") {
+                cout << bc.name << "," << size << "," << iterations << "," << mbps << "," << nspb << "," << apc << "\n";
+            } else if (format == "json") {
+                cout << "{\"cipher\":\"" << bc.name << "\",\"bytes\":" << size << ",\"iterations\":" << iterations
+                     << ",\"mb_per_s\":" << mbps << ",\"ns_per_byte\":" << nspb << ",\"allocs_per_call\":" << apc << "}\n";
+            } else {
+                cout << left << setw(26) << bc.name << right << setw(8) << formatSize(size) << fixed
+                     << setprecision(1) << setw(12) << mbps << setprecision(3) << setw(12) << nspb
+                     << setprecision(2) << setw(14) << apc << defaultfloat << "\n";
+            }
+            cout.flush();
+            if (elapsed / iterations > BENCH_SKIP_SECONDS) break;
+        }
+    }
+    if (ranRsa2048) {
+        // Montgomery multiplications per 2048-bit exponentiation, automatic
+        // method vs plain square-and-multiply.
+        const RsaPrivateKey<32> &key = rsa2048();
+        Montgomery<32> mont(key.n);
+        PowStats fast, plain, fastE, plainE;
+        mont.pow(UInt2048(12345), key.d, &fast);
+        mont.powBinary(UInt2048(12345), key.d, &plain);
+        mont.pow(UInt2048(12345), UInt2048(65537), &fastE);
+        mont.powBinary(UInt2048(12345), UInt2048(65537), &plainE);
+        cerr << "rsa2048 multiplies per op: private exponent " << fast.total() << " (sliding window) vs "
+             << plain.total() << " (binary); e = 65537 " << fastE.total() << " vs " << plainE.total() << "\n";
+    }
+    ColumnarPlanStats plans = columnarPlanCacheStats();
+    if (plans.hits + plans.misses > 0)
+        cerr << "columnar plan cache: " << plans.hits << " hits, " << plans.misses << " misses, "
+             << plans.evictions << " evictions, " << plans.entries << "/" << plans.capacity << " plans\n";
+    return 0;
+}
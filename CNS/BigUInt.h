@@ -0,0 +1,443 @@
+// Fixed-width multi-precision integers for RSAalgo.cpp.
+//
+// BigUInt<Limbs> stores Limbs 64-bit words, least significant first, so
+// UInt2048 is BigUInt<32>. Like the built-in unsigned types it wraps modulo
+// 2^(64 * Limbs) on overflow; pick a width at least twice the key size when
+// intermediate products must not wrap. Limb products use unsigned __int128
+// (GCC/Clang).
+//
+// Montgomery<Limbs> keeps an odd modulus n with its precomputed constants and
+// multiplies residues in Montgomery form (a * R mod n, R = 2^(64 * Limbs)), so
+// modular exponentiation needs no division at all: each step is one CIOS
+// multiply-and-reduce pass over the limbs.
+
+#ifndef BIG_UINT_H
+#define BIG_UINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+template<size_t Limbs>
+struct BigUInt {
+    static_assert(Limbs > 0, "BigUInt needs at least one limb");
+    static const size_t BITS = 64 * Limbs;
+
+    uint64_t limb[Limbs] = {};
+
+    BigUInt() {}
+    BigUInt(uint64_t value) { limb[0] = value; }
+
+    // Decimal, or hexadecimal with a 0x prefix. Throws std::invalid_argument
+    // on a bad digit and std::overflow_error if the value does not fit.
+    static BigUInt fromString(const std::string &text) {
+        bool hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+        uint64_t radix = hex ? 16 : 10;
+        if (text.empty()) throw std::invalid_argument("empty number");
+        BigUInt value;
+        for (size_t i = hex ? 2 : 0; i < text.size(); i++) {
+            char c = text[i];
+            uint64_t digit = c >= '0' && c <= '9' ? c - '0'
+                           : (c | 0x20) >= 'a' && (c | 0x20) <= 'f' ? (c | 0x20) - 'a' + 10 : 99;
+            if (digit >= radix) throw std::invalid_argument("bad digit in '" + text + "'");
+            if (value.mulSmall(radix) || value.addSmall(digit)) throw std::overflow_error("number too large");
+        }
+        return value;
+    }
+
+    std::string toString() const {
+        if (isZero()) return "0";
+        // Peel off 19 decimal digits at a time.
+        const uint64_t CHUNK = 10000000000000000000ull;
+        BigUInt v = *this;
+        std::string out;
+        while (!v.isZero()) {
+            uint64_t part = v.divSmall(CHUNK);
+            for (int i = 0; i < 19 && (part || !v.isZero()); i++, part /= 10) out += char('0' + part % 10);
+        }
+        return std::string(out.rbegin(), out.rend());
+    }
+
+    // Big-endian bytes, as used for packing messages into blocks.
+    static BigUInt fromBytes(const unsigned char *bytes, size_t len) {
+        BigUInt value;
+        for (size_t i = 0; i < len && i < 8 * Limbs; i++) {
+            size_t pos = len - 1 - i;
+            value.limb[i / 8] |= (uint64_t)bytes[pos] << (8 * (i % 8));
+        }
+        return value;
+    }
+    void toBytes(unsigned char *bytes, size_t len) const {
+        for (size_t i = 0; i < len; i++)
+            bytes[len - 1 - i] = i < 8 * Limbs ? (unsigned char)(limb[i / 8] >> (8 * (i % 8))) : 0;
+    }
+
+    bool isZero() const {
+        for (size_t i = 0; i < Limbs; i++)
+            if (limb[i]) return false;
+        return true;
+    }
+    bool isOdd() const { return limb[0] & 1; }
+    bool bit(size_t i) const { return (limb[i / 64] >> (i % 64)) & 1; }
+    void setBit(size_t i) { limb[i / 64] |= (uint64_t)1 << (i % 64); }
+    size_t bitLength() const {
+        for (size_t i = Limbs; i-- > 0;)
+            if (limb[i]) return 64 * i + 64 - __builtin_clzll(limb[i]);
+        return 0;
+    }
+    uint64_t low() const { return limb[0]; }
+
+    // Same value in a different width (truncating when narrower).
+    template<size_t Other>
+    BigUInt<Other> resize() const {
+        BigUInt<Other> r;
+        for (size_t i = 0; i < Limbs && i < Other; i++) r.limb[i] = limb[i];
+        return r;
+    }
+
+    friend int compare(const BigUInt &a, const BigUInt &b) {
+        for (size_t i = Limbs; i-- > 0;)
+            if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i] ? -1 : 1;
+        return 0;
+    }
+    friend bool operator==(const BigUInt &a, const BigUInt &b) { return compare(a, b) == 0; }
+    friend bool operator!=(const BigUInt &a, const BigUInt &b) { return compare(a, b) != 0; }
+    friend bool operator<(const BigUInt &a, const BigUInt &b) { return compare(a, b) < 0; }
+    friend bool operator<=(const BigUInt &a, const BigUInt &b) { return compare(a, b) <= 0; }
+    friend bool operator>(const BigUInt &a, const BigUInt &b) { return compare(a, b) > 0; }
+    friend bool operator>=(const BigUInt &a, const BigUInt &b) { return compare(a, b) >= 0; }
+
+    // In-place add/subtract; both return the carry (borrow) out of the top.
+    uint64_t add(const BigUInt &b) {
+        unsigned __int128 carry = 0;
+        for (size_t i = 0; i < Limbs; i++) {
+            carry += (unsigned __int128)limb[i] + b.limb[i];
+            limb[i] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        return (uint64_t)carry;
+    }
+    uint64_t sub(const BigUInt &b) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < Limbs; i++) {
+            unsigned __int128 d = (unsigned __int128)limb[i] - b.limb[i] - borrow;
+            limb[i] = (uint64_t)d;
+            borrow = (uint64_t)(d >> 64) & 1;
+        }
+        return borrow;
+    }
+    uint64_t addSmall(uint64_t v) {
+        for (size_t i = 0; i < Limbs && v; i++) {
+            limb[i] += v;
+            v = limb[i] < v;
+        }
+        return v;
+    }
+    uint64_t mulSmall(uint64_t v) {
+        unsigned __int128 carry = 0;
+        for (size_t i = 0; i < Limbs; i++) {
+            carry += (unsigned __int128)limb[i] * v;
+            limb[i] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        return (uint64_t)carry;
+    }
+    // Divides in place and returns the remainder.
+    uint64_t divSmall(uint64_t v) {
+        unsigned __int128 rem = 0;
+        for (size_t i = Limbs; i-- > 0;) {
+            rem = rem << 64 | limb[i];
+            limb[i] = (uint64_t)(rem / v);
+            rem %= v;
+        }
+        return (uint64_t)rem;
+    }
+    uint64_t modSmall(uint64_t v) const {
+        unsigned __int128 rem = 0;
+        for (size_t i = Limbs; i-- > 0;) rem = (rem << 64 | limb[i]) % v;
+        return (uint64_t)rem;
+    }
+
+    BigUInt &operator+=(const BigUInt &b) { add(b); return *this; }
+    BigUInt &operator-=(const BigUInt &b) { sub(b); return *this; }
+    friend BigUInt operator+(BigUInt a, const BigUInt &b) { return a += b; }
+    friend BigUInt operator-(BigUInt a, const BigUInt &b) { return a -= b; }
+
+    BigUInt &operator<<=(size_t s) {
+        if (s >= BITS) return *this = BigUInt();
+        size_t words = s / 64, bits = s % 64;
+        for (size_t i = Limbs; i-- > 0;) {
+            uint64_t v = i >= words ? limb[i - words] << bits : 0;
+            if (bits && i > words) v |= limb[i - words - 1] >> (64 - bits);
+            limb[i] = v;
+        }
+        return *this;
+    }
+    BigUInt &operator>>=(size_t s) {
+        if (s >= BITS) return *this = BigUInt();
+        size_t words = s / 64, bits = s % 64;
+        for (size_t i = 0; i < Limbs; i++) {
+            uint64_t v = i + words < Limbs ? limb[i + words] >> bits : 0;
+            if (bits && i + words + 1 < Limbs) v |= limb[i + words + 1] << (64 - bits);
+            limb[i] = v;
+        }
+        return *this;
+    }
+    friend BigUInt operator<<(BigUInt a, size_t s) { return a <<= s; }
+    friend BigUInt operator>>(BigUInt a, size_t s) { return a >>= s; }
+
+    // Low Limbs words of the product; see mulWide for the full result.
+    friend BigUInt operator*(const BigUInt &a, const BigUInt &b) {
+        BigUInt r;
+        for (size_t i = 0; i < Limbs; i++) {
+            unsigned __int128 carry = 0;
+            for (size_t j = 0; i + j < Limbs; j++) {
+                carry += (unsigned __int128)a.limb[j] * b.limb[i] + r.limb[i + j];
+                r.limb[i + j] = (uint64_t)carry;
+                carry >>= 64;
+            }
+        }
+        return r;
+    }
+    BigUInt &operator*=(const BigUInt &b) { return *this = *this * b; }
+
+    // Shift-subtract long division, starting at the divisor's bit length so
+    // the cost is proportional to the quotient size. Throws on b == 0.
+    static void divMod(const BigUInt &a, const BigUInt &b, BigUInt &quot, BigUInt &rem) {
+        if (b.isZero()) throw std::domain_error("division by zero");
+        BigUInt num = a, q, r;
+        size_t la = num.bitLength(), lb = b.bitLength();
+        if (la >= lb) {
+            size_t s = la - lb;
+            r = num >> s;
+            if (r >= b) { r -= b; q.setBit(s); }
+            for (size_t i = s; i-- > 0;) {
+                bool top = r.bit(BITS - 1);
+                r <<= 1;
+                r.limb[0] |= num.bit(i);
+                if (top || r >= b) { r -= b; q.setBit(i); }
+            }
+        } else {
+            r = num;
+        }
+        quot = q;
+        rem = r;
+    }
+    friend BigUInt operator/(const BigUInt &a, const BigUInt &b) { BigUInt q, r; divMod(a, b, q, r); return q; }
+    friend BigUInt operator%(const BigUInt &a, const BigUInt &b) { BigUInt q, r; divMod(a, b, q, r); return r; }
+    BigUInt &operator%=(const BigUInt &b) { return *this = *this % b; }
+};
+
+using UInt512 = BigUInt<8>;
+using UInt1024 = BigUInt<16>;
+using UInt2048 = BigUInt<32>;
+using UInt4096 = BigUInt<64>;
+
+// Full 2 * Limbs-word product.
+template<size_t Limbs>
+BigUInt<2 * Limbs> mulWide(const BigUInt<Limbs> &a, const BigUInt<Limbs> &b) {
+    BigUInt<2 * Limbs> r;
+    for (size_t i = 0; i < Limbs; i++) {
+        unsigned __int128 carry = 0;
+        for (size_t j = 0; j < Limbs; j++) {
+            carry += (unsigned __int128)a.limb[j] * b.limb[i] + r.limb[i + j];
+            r.limb[i + j] = (uint64_t)carry;
+            carry >>= 64;
+        }
+        r.limb[i + Limbs] = (uint64_t)carry;
+    }
+    return r;
+}
+
+// Montgomery multiplications done by one or more exponentiations.
+struct PowStats {
+    uint64_t squarings = 0;
+    uint64_t multiplies = 0;
+    uint64_t total() const { return squarings + multiplies; }
+    PowStats &operator+=(const PowStats &o) {
+        squarings += o.squarings;
+        multiplies += o.multiplies;
+        return *this;
+    }
+};
+
+template<size_t Limbs>
+class Montgomery {
+public:
+    using Int = BigUInt<Limbs>;
+
+    // Throws std::domain_error unless the modulus is odd and greater than 1.
+    explicit Montgomery(const Int &modulus) : n(modulus) {
+        if (!n.isOdd() || n == Int(1)) throw std::domain_error("Montgomery modulus must be odd and > 1");
+        // Newton iteration for n[0]^-1 mod 2^64; each step doubles the
+        // number of correct low bits (3 -> 6 -> ... -> 96).
+        uint64_t inv = n.limb[0];
+        for (int i = 0; i < 5; i++) inv *= 2 - n.limb[0] * inv;
+        n0inv = 0 - inv;
+        // R mod n and R^2 mod n by doubling, so setup needs no division.
+        Int x(1);
+        for (size_t i = 0; i < 2 * Int::BITS; i++) {
+            uint64_t carry = x.add(x);
+            if (carry || x >= n) x.sub(n);
+            if (i + 1 == Int::BITS) rModN = x;
+        }
+        r2 = x;
+    }
+
+    const Int &modulus() const { return n; }
+
+    // a (any value) -> a * R mod n, and back.
+    Int toMont(const Int &a) const { return mul(a < n ? a : a % n, r2); }
+    Int fromMont(const Int &a) const { return mul(a, Int(1)); }
+    const Int &one() const { return rModN; }
+
+    // x mod n for a double-width x = hi * R + lo, in two multiplies:
+    // x * R^-1 = hi + lo * R^-1, then multiply by R again via R^2.
+    Int reduce(const BigUInt<2 * Limbs> &x) const {
+        Int hi, lo;
+        for (size_t i = 0; i < Limbs; i++) {
+            lo.limb[i] = x.limb[i];
+            hi.limb[i] = x.limb[i + Limbs];
+        }
+        Int z = mul(lo, Int(1));
+        if (z.add(hi) || z >= n) z.sub(n);   // hi < R, so one subtraction keeps z < R
+        return mul(z, r2);
+    }
+
+    // a * b * R^-1 mod n for a, b < n (CIOS: multiply in one word of b, then
+    // reduce one word away, keeping the running sum in Limbs + 2 words).
+    // Separate multiply and reduce sweeps measured faster than a fused loop.
+    Int mul(const Int &a, const Int &b) const {
+        uint64_t t[Limbs + 2] = {};
+        for (size_t i = 0; i < Limbs; i++) {
+            unsigned __int128 carry = 0;
+            for (size_t j = 0; j < Limbs; j++) {
+                carry += (unsigned __int128)a.limb[j] * b.limb[i] + t[j];
+                t[j] = (uint64_t)carry;
+                carry >>= 64;
+            }
+            carry += t[Limbs];
+            t[Limbs] = (uint64_t)carry;
+            t[Limbs + 1] = (uint64_t)(carry >> 64);
+
+            uint64_t m = t[0] * n0inv;
+            carry = ((unsigned __int128)m * n.limb[0] + t[0]) >> 64;
+            for (size_t j = 1; j < Limbs; j++) {
+                carry += (unsigned __int128)m * n.limb[j] + t[j];
+                t[j - 1] = (uint64_t)carry;
+                carry >>= 64;
+            }
+            carry += t[Limbs];
+            t[Limbs - 1] = (uint64_t)carry;
+            t[Limbs] = t[Limbs + 1] + (uint64_t)(carry >> 64);
+        }
+        Int r;
+        for (size_t i = 0; i < Limbs; i++) r.limb[i] = t[i];
+        if (t[Limbs] || r >= n) r.sub(n);
+        return r;
+    }
+
+    // base^exp mod n; base and result in normal (not Montgomery) form.
+    // Picks the cheapest method for the exponent: exponents of the form
+    // 2^k + 1 (3, 17, 65537) take k squarings and one multiply; others use a
+    // left-to-right sliding window over precomputed odd powers.
+    template<size_t ExpLimbs>
+    Int pow(const Int &base, const BigUInt<ExpLimbs> &exp, PowStats *stats = nullptr) const {
+        size_t bits = exp.bitLength();
+        if (bits == 0) return fromMont(rModN);
+        Int b = toMont(base);
+        PowStats local;
+        Int acc = isPowerOfTwoPlusOne(exp) ? powFermat(b, bits - 1, local) : powWindow(b, exp, local);
+        if (stats) *stats += local;
+        return fromMont(acc);
+    }
+
+    // Plain square-and-multiply over every exponent bit, kept as the
+    // reference the faster paths are measured against.
+    template<size_t ExpLimbs>
+    Int powBinary(const Int &base, const BigUInt<ExpLimbs> &exp, PowStats *stats = nullptr) const {
+        Int b = toMont(base), acc = rModN;
+        for (size_t i = exp.bitLength(); i-- > 0;) {
+            acc = mul(acc, acc);
+            if (exp.bit(i)) acc = mul(acc, b);
+            if (stats) {
+                stats->squarings++;
+                stats->multiplies += exp.bit(i);
+            }
+        }
+        return fromMont(acc);
+    }
+
+    // Window width by exponent size, as OpenSSL's BN_window_bits_for_exponent_size:
+    // wider windows save multiplies but cost 2^(w-1) precomputed powers.
+    static int windowBits(size_t bits) {
+        return bits > 671 ? 6 : bits > 239 ? 5 : bits > 79 ? 4 : bits > 23 ? 3 : 1;
+    }
+
+private:
+    static const int MAX_WINDOW = 6;
+
+    template<size_t ExpLimbs>
+    static bool isPowerOfTwoPlusOne(const BigUInt<ExpLimbs> &exp) {
+        int ones = 0;
+        for (size_t i = 0; i < ExpLimbs; i++) ones += __builtin_popcountll(exp.limb[i]);
+        return ones == 2 && exp.bit(0);
+    }
+
+    // b^(2^k + 1), Montgomery form in and out.
+    Int powFermat(const Int &b, size_t k, PowStats &stats) const {
+        Int acc = b;
+        for (size_t i = 0; i < k; i++) acc = mul(acc, acc);
+        stats.squarings += k;
+        stats.multiplies++;
+        return mul(acc, b);
+    }
+
+    // Sliding window: odd[i] = b^(2i + 1). Each window is a run of at most w
+    // bits that starts and ends with a 1; zeros between windows cost one
+    // squaring each. exp must be non-zero.
+    template<size_t ExpLimbs>
+    Int powWindow(const Int &b, const BigUInt<ExpLimbs> &exp, PowStats &stats) const {
+        size_t bits = exp.bitLength();
+        int w = windowBits(bits);
+        Int odd[1 << (MAX_WINDOW - 1)];
+        odd[0] = b;
+        if (w > 1) {
+            Int b2 = mul(b, b);
+            for (int i = 1; i < 1 << (w - 1); i++) odd[i] = mul(odd[i - 1], b2);
+            stats.squarings++;
+            stats.multiplies += (1 << (w - 1)) - 1;
+        }
+        Int acc;
+        bool started = false;
+        for (ptrdiff_t i = (ptrdiff_t)bits - 1; i >= 0;) {
+            if (!exp.bit(i)) {
+                acc = mul(acc, acc);
+                stats.squarings++;
+                i--;
+                continue;
+            }
+            ptrdiff_t j = i + 1 >= w ? i + 1 - w : 0;
+            while (!exp.bit(j)) j++;
+            unsigned value = 0;
+            for (ptrdiff_t k = i; k >= j; k--) value = value << 1 | exp.bit(k);
+            if (started) {
+                for (ptrdiff_t k = i; k >= j; k--) acc = mul(acc, acc);
+                acc = mul(acc, odd[value >> 1]);
+                stats.squarings += i - j + 1;
+                stats.multiplies++;
+            } else {
+                acc = odd[value >> 1];
+                started = true;
+            }
+            i = j - 1;
+        }
+        return acc;
+    }
+
+    Int n, rModN, r2;
+    uint64_t n0inv;
+};
+
+#endif
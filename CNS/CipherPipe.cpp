@@ -0,0 +1,299 @@
+// Non-interactive cipher pipeline for batch jobs.
+//
+// Build: g++ -O2 -std=c++17 -pthread CipherPipe.cpp -o CipherPipe.exe
+// Usage: CipherPipe.exe [-d] [-i FILE] [-o FILE] [--chunk SIZE] [--block SIZE] STAGE...
+//
+// Stages run left to right in one streaming pass over the input (stdin by
+// default); with -d they run right to left, each one deciphering. Stages:
+//   caesar:K            affine:A,B          substitution:ALPHABET
+//   vigenere:KEY        vernam:KEY          hill:K11,K12,...,KNN (row-major)
+//   railfence[:R[,OFF]] columnar:3,1,4,2    double:3,1,4,2
+// e.g.  CipherPipe.exe -i big.txt vigenere:LEMON double:3,1,4,2 > big.enc
+//       CipherPipe.exe -d -i big.enc vigenere:LEMON double:3,1,4,2
+//
+// Data moves between stages in fixed-size buffers, so memory stays bounded by
+// the chunk and block sizes whatever the input size. Substitution ciphers are
+// one table lookup per byte into the next stage's buffer; Vigenere/Vernam
+// carry their key phase across chunks; Hill carries an incomplete block of
+// letters. Transpositions cannot stream over an unbounded message, so they
+// work on independent records of --block bytes (rounded up to a multiple of
+// the key width); a short final record is padded with spaces as the
+// transposition functions do. Record boundaries and that padding only line
+// up again on -d when every transposition stage in the chain has the same
+// key width (rail fence counts as width 1) and no Hill stage comes after a
+// transposition (Hill drops the padding spaces); other chains are rejected.
+
+#include <cstdio>
+#include <memory>
+#include <functional>
+
+#define CNS_NO_MAIN
+#include "Practical_1.cpp"
+#include "Practical_2.cpp"
+
+struct Stage {
+    virtual ~Stage() {}
+    // Transform n bytes of `in`, appending the result to `out`.
+    virtual void process(const char *in, size_t n, vector<char> &out) = 0;
+    // End of stream: emit anything still buffered.
+    virtual void finish(vector<char> &) {}
+};
+
+// Caesar, Affine and substitution: one 26-entry table, no state between chunks.
+struct MonoStage : Stage {
+    uint8_t tab[32];
+    void process(const char *in, size_t n, vector<char> &out) override {
+        size_t o = out.size();
+        out.resize(o + n);
+        monoSubstitute(tab, in, out.data() + o, n);
+    }
+};
+
+// Vigenere/Vernam: the key phase continues from the previous chunk.
+struct PolyStage : Stage {
+    string key, rotated;
+    PolyCipher kind;
+    bool decrypt;
+    size_t offset = 0;
+    void process(const char *in, size_t n, vector<char> &out) override {
+        size_t ph = offset % key.size();
+        rotated.assign(key, ph, string::npos);
+        rotated.append(key, 0, ph);
+        size_t o = out.size();
+        out.resize(o + n);
+        size_t done = polyTransform(string_view(in, n), rotated, kind, decrypt, out.data() + o);
+        if (done < n) throw runtime_error("Vigenere stage stopped at a case mismatch");
+        offset += n;
+    }
+};
+
+// Hill: letters only; an incomplete block waits for the next chunk.
+struct HillStage : Stage {
+    vector<int> key;
+    int n = 0;
+    bool decrypt = false;
+    string pending;
+    void process(const char *in, size_t len, vector<char> &out) override {
+        size_t o = out.size();
+        out.insert(out.end(), pending.begin(), pending.end());
+        for (size_t i = 0; i < len; i++)
+            if (isalpha(in[i])) out.push_back(toupper(in[i]));
+        size_t letters = out.size() - o, full = letters / n * n;
+        hillKernel(out.data() + o, out.data() + o, full / n, key.data(), n);
+        pending.assign(out.begin() + o + full, out.end());
+        out.resize(o + full);
+    }
+    void finish(vector<char> &out) override {
+        if (decrypt || pending.empty()) return;
+        while (pending.size() % n) pending += 'X';
+        size_t o = out.size();
+        out.insert(out.end(), pending.begin(), pending.end());
+        hillKernel(out.data() + o, out.data() + o, pending.size() / n, key.data(), n);
+        pending.clear();
+    }
+};
+
+// Transpositions: independent fixed-size records.
+struct BlockStage : Stage {
+    function<size_t(string_view, char *)> transform;
+    size_t record = 0, keyWidth = 1;
+    vector<char> pending;
+    void emit(vector<char> &out) {
+        size_t o = out.size();
+        out.resize(o + columnarOutputLength(pending.size(), keyWidth));
+        out.resize(o + transform(string_view(pending.data(), pending.size()), out.data() + o));
+        pending.clear();
+    }
+    void process(const char *in, size_t n, vector<char> &out) override {
+        while (n > 0) {
+            size_t take = min(n, record - pending.size());
+            pending.insert(pending.end(), in, in + take);
+            in += take;
+            n -= take;
+            if (pending.size() == record) emit(out);
+        }
+    }
+    void finish(vector<char> &out) override {
+        if (!pending.empty()) emit(out);
+    }
+};
+
+static vector<int> parseInts(const string &text) {
+    vector<int> values;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == string::npos) end = text.size();
+        values.push_back(stoi(text.substr(pos, end - pos)));
+        pos = end + 1;
+    }
+    return values;
+}
+
+static bool isPermutationKey(const vector<int> &key) {
+    vector<bool> seen(key.size() + 1, false);
+    for (int k : key) {
+        if (k < 1 || (size_t)k > key.size() || seen[k]) return false;
+        seen[k] = true;
+    }
+    return !key.empty();
+}
+
+static unique_ptr<Stage> makeStage(const string &spec, bool decrypt, size_t block) {
+    size_t colon = spec.find(':');
+    string name = spec.substr(0, colon), arg = colon == string::npos ? "" : spec.substr(colon + 1);
+
+    if (name == "caesar" || name == "affine" || name == "substitution") {
+        auto st = make_unique<MonoStage>();
+        if (name == "caesar") {
+            caesarTable((stoi(arg) % 26 + 26) % 26, decrypt, st->tab);
+        } else if (name == "affine") {
+            vector<int> k = parseInts(arg);
+            if (k.size() != 2) throw runtime_error("affine needs A,B with gcd(A, 26) = 1");
+            for (int &v : k) v = (v % 26 + 26) % 26;   // negative keys wrap like positive ones
+            if (modInverse(k[0], 26) == -1) throw runtime_error("affine needs A,B with gcd(A, 26) = 1");
+            affineTable(k[0], k[1], decrypt, st->tab);
+        } else if (!substitutionTable(arg, decrypt, st->tab)) {
+            throw runtime_error("substitution needs a 26-letter permutation");
+        }
+        return st;
+    }
+    if (name == "vigenere" || name == "vernam") {
+        if (arg.empty()) throw runtime_error(name + " needs a key");
+        auto st = make_unique<PolyStage>();
+        st->key = arg;
+        st->kind = name == "vigenere" ? POLY_VIGENERE : POLY_VERNAM;
+        st->decrypt = decrypt;
+        return st;
+    }
+    if (name == "hill") {
+        vector<int> k = parseInts(arg);
+        int n = 1;
+        while (n * n < (int)k.size()) n++;
+        if (n * n != (int)k.size() || n > HILL_MAX_N) throw runtime_error("hill needs N*N key entries");
+        vector<vector<int>> matrix(n, vector<int>(n));
+        for (int i = 0; i < n * n; i++) matrix[i / n][i % n] = k[i];
+        auto st = make_unique<HillStage>();
+        st->n = n;
+        st->decrypt = decrypt;
+        vector<int> flat;
+        flattenHillKey(matrix, flat);
+        if (!decrypt) st->key = flat;
+        else if (!inverseHillKey(flat, n, st->key)) throw runtime_error("hill key is not invertible mod 26");
+        return st;
+    }
+    if (name == "railfence" || name == "columnar" || name == "double") {
+        auto st = make_unique<BlockStage>();
+        if (name == "railfence") {
+            vector<int> k = arg.empty() ? vector<int>{2} : parseInts(arg);
+            if (k.size() > 2 || k[0] < 1 || (k.size() == 2 && k[1] < 0)) throw runtime_error("railfence needs RAILS[,OFFSET]");
+            int rails = k[0];
+            size_t offset = k.size() == 2 ? k[1] : 0;
+            st->transform = [rails, offset, decrypt](string_view in, char *out) {
+                return decrypt ? railFenceDecipher(in, out, rails, offset) : railFenceCipher(in, out, rails, offset);
+            };
+        } else {
+            vector<int> key = parseInts(arg);
+            if (!isPermutationKey(key)) throw runtime_error(name + " needs a permutation of 1..N");
+            st->keyWidth = key.size();
+            if (name == "columnar")
+                st->transform = [key, decrypt](string_view in, char *out) {
+                    return decrypt ? singleColumnTranspositionDecipher(in, out, key)
+                                   : singleColumnTranspositionCipher(in, out, key);
+                };
+            else
+                st->transform = [key, decrypt](string_view in, char *out) {
+                    return decrypt ? doubleColumnTranspositionDecipher(in, out, key)
+                                   : doubleColumnTranspositionCipher(in, out, key);
+                };
+        }
+        st->record = columnarOutputLength(block, st->keyWidth);
+        st->pending.reserve(st->record);
+        return st;
+    }
+    throw runtime_error("unknown stage '" + name + "'");
+}
+
+static size_t parseSize(const string &text) {
+    char *end = nullptr;
+    double v = strtod(text.c_str(), &end);
+    switch (end && *end ? toupper(*end) : 0) {
+        case 'K': v *= 1024; break;
+        case 'M': v *= 1024 * 1024; break;
+    }
+    return max<size_t>(1, (size_t)v);
+}
+
+int main(int argc, char **argv) {
+    bool decrypt = false;
+    string inPath, outPath;
+    size_t chunk = 64 * 1024, block = 4096;
+    vector<string> specs;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-d") decrypt = true;
+        else if (arg == "-i" && hasValue) inPath = argv[++i];
+        else if (arg == "-o" && hasValue) outPath = argv[++i];
+        else if (arg == "--chunk" && hasValue) chunk = parseSize(argv[++i]);
+        else if (arg == "--block" && hasValue) block = parseSize(argv[++i]);
+        else if (arg[0] != '-') specs.push_back(arg);
+        else specs.clear(), i = argc;
+    }
+    if (specs.empty()) {
+        cerr << "Usage: " << argv[0] << " [-d] [-i FILE] [-o FILE] [--chunk SIZE] [--block SIZE] STAGE...\n"
+             << "Stages: caesar:K affine:A,B substitution:ALPHABET vigenere:KEY vernam:KEY\n"
+             << "        hill:K11,...,KNN railfence:RAILS,OFFSET columnar:3,1,4,2 double:3,1,4,2\n";
+        return 1;
+    }
+
+    try {
+        vector<unique_ptr<Stage>> stages;
+        size_t width = 0;
+        for (const string &spec : specs) {
+            stages.push_back(makeStage(spec, decrypt, block));
+            auto *bs = dynamic_cast<BlockStage *>(stages.back().get());
+            if (bs && width && bs->keyWidth != width)
+                throw runtime_error("transposition stages must all use the same key width");
+            if (width && dynamic_cast<HillStage *>(stages.back().get()))
+                throw runtime_error("hill cannot follow a transposition stage");
+            if (bs) width = bs->keyWidth;
+        }
+        if (decrypt) reverse(stages.begin(), stages.end());
+
+        FILE *in = inPath.empty() ? stdin : fopen(inPath.c_str(), "rb");
+        FILE *out = outPath.empty() ? stdout : fopen(outPath.c_str(), "wb");
+        if (!in || !out) throw runtime_error("cannot open input/output file");
+
+        // buffers[i] feeds stage i; the last one goes to the output.
+        vector<vector<char>> buffers(stages.size() + 1);
+        for (auto &b : buffers) b.reserve(2 * chunk + 2 * block);
+        auto runFrom = [&](size_t first, bool eof) {
+            for (size_t s = first; s < stages.size(); s++) {
+                buffers[s + 1].clear();
+                if (!buffers[s].empty()) stages[s]->process(buffers[s].data(), buffers[s].size(), buffers[s + 1]);
+                if (eof) stages[s]->finish(buffers[s + 1]);
+            }
+            vector<char> &last = buffers.back();
+            if (!last.empty() && fwrite(last.data(), 1, last.size(), out) != last.size())
+                throw runtime_error("write failed");
+        };
+
+        size_t got;
+        buffers[0].resize(chunk);
+        while ((got = fread(buffers[0].data(), 1, chunk, in)) > 0) {
+            buffers[0].resize(got);
+            runFrom(0, false);
+            buffers[0].resize(chunk);
+        }
+        buffers[0].clear();
+        runFrom(0, true);
+
+        if (in != stdin) fclose(in);
+        if (out != stdout && fclose(out) != 0) throw runtime_error("write failed");
+    } catch (const exception &ex) {
+        cerr << "CipherPipe: " << ex.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// English n-gram fitness used by the cryptanalysis modes in Practical_1.cpp
+// and Practical_2.cpp.
+//
+// Candidate plaintexts are scored as the sum of log10 quadgram probabilities.
+// If a quadgram count file (one "TION 13168375" pair per line, e.g. the
+// widely used english_quadgrams.txt) is found it is used as-is; otherwise a
+// smaller model is trained from the built-in sample text below, with the
+// quadgram probability backed off to trigram/bigram/unigram estimates so that
+// unseen quadgrams still get a sensible score.
+
+#ifndef NGRAM_SCORE_H
+#define NGRAM_SCORE_H
+
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+class NgramScorer {
+public:
+    NgramScorer() : quad(26 * 26 * 26 * 26), bi(26 * 26) { trainFromText(sampleText()); }
+
+    // Shared English model: english_quadgrams.txt from the working directory
+    // when present, else the built-in sample. Built once, thread-safe.
+    static const NgramScorer& english() {
+        static const NgramScorer instance = [] {
+            NgramScorer s;
+            s.loadQuadgrams("english_quadgrams.txt");
+            return s;
+        }();
+        return instance;
+    }
+
+    // Returns false (and keeps the current model) if the file can't be read.
+    bool loadQuadgrams(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) return false;
+        std::vector<double> counts(quad.size(), 0.0);
+        std::string gram;
+        double count, total = 0;
+        while (in >> gram >> count) {
+            if (gram.size() != 4) continue;
+            int idx = 0;
+            bool ok = true;
+            for (char ch : gram) {
+                if (!isalpha((unsigned char)ch)) { ok = false; break; }
+                idx = idx * 26 + (toupper((unsigned char)ch) - 'A');
+            }
+            if (!ok) continue;
+            counts[idx] += count;
+            total += count;
+        }
+        if (total == 0) return false;
+
+        std::vector<double> biCounts(bi.size(), 0.0);
+        double floorLog = std::log10(0.01 / total);
+        for (size_t i = 0; i < quad.size(); i++) {
+            quad[i] = counts[i] > 0 ? (float)std::log10(counts[i] / total) : (float)floorLog;
+            biCounts[i / (26 * 26)] += counts[i];
+        }
+        for (size_t i = 0; i < bi.size(); i++)
+            bi[i] = biCounts[i] > 0 ? (float)std::log10(biCounts[i] / total) : (float)floorLog;
+        return true;
+    }
+
+    // Letters are given as indices 0..25.
+    float quadgram(int a, int b, int c, int d) const { return quad[((a * 26 + b) * 26 + c) * 26 + d]; }
+    float bigram(int a, int b) const { return bi[a * 26 + b]; }
+
+    double score(const uint8_t* letters, size_t n) const {
+        double s = 0;
+        for (size_t i = 0; i + 3 < n; i++)
+            s += quadgram(letters[i], letters[i + 1], letters[i + 2], letters[i + 3]);
+        return s;
+    }
+
+    double bigramScore(const uint8_t* letters, size_t n) const {
+        double s = 0;
+        for (size_t i = 0; i + 1 < n; i++) s += bigram(letters[i], letters[i + 1]);
+        return s;
+    }
+
+private:
+    std::vector<float> quad;
+    std::vector<float> bi;
+
+    // Interpolated chain P(a) P(b|a) P(c|ab) P(d|abc); each conditional is
+    // blended with the next lower order so sparse counts stay usable.
+    void trainFromText(const char* text) {
+        std::vector<uint8_t> s;
+        for (const char* p = text; *p; p++)
+            if (isalpha((unsigned char)*p)) s.push_back(toupper((unsigned char)*p) - 'A');
+
+        std::vector<double> c1(26, 1.0), c2(26 * 26, 0.0), c3(26 * 26 * 26, 0.0), c4(quad.size(), 0.0);
+        for (size_t i = 0; i < s.size(); i++) {
+            c1[s[i]]++;
+            if (i + 1 < s.size()) c2[s[i] * 26 + s[i + 1]]++;
+            if (i + 2 < s.size()) c3[(s[i] * 26 + s[i + 1]) * 26 + s[i + 2]]++;
+            if (i + 3 < s.size()) c4[((s[i] * 26 + s[i + 1]) * 26 + s[i + 2]) * 26 + s[i + 3]]++;
+        }
+        double n1 = s.size() + 26.0;
+        std::vector<double> h1(26, 0.0), h2(26 * 26, 0.0), h3(26 * 26 * 26, 0.0);
+        for (int i = 0; i < 26 * 26; i++) h1[i / 26] += c2[i];
+        for (int i = 0; i < 26 * 26 * 26; i++) h2[i / 26] += c3[i];
+        for (size_t i = 0; i < quad.size(); i++) h3[i / 26] += c4[i];
+
+        auto blend = [](double hits, double ctx, double lower) {
+            const double lambda = 0.6;
+            return ctx > 0 ? lambda * hits / ctx + (1 - lambda) * lower : lower;
+        };
+        std::vector<double> p2(26 * 26), p3(26 * 26 * 26);
+        for (int a = 0; a < 26; a++)
+            for (int b = 0; b < 26; b++) {
+                int i = a * 26 + b;
+                p2[i] = blend(c2[i], h1[a], c1[b] / n1);
+                bi[i] = (float)std::log10(c1[a] / n1 * p2[i]);
+            }
+        for (int i = 0; i < 26 * 26 * 26; i++)
+            p3[i] = blend(c3[i], h2[i / 26], p2[i % (26 * 26)]);
+        for (size_t i = 0; i < quad.size(); i++) {
+            double p4 = blend(c4[i], h3[i / 26], p3[i % (26 * 26 * 26)]);
+            quad[i] = (float)std::log10(c1[i / (26 * 26 * 26)] / n1 * p2[i / (26 * 26)] * p3[i / 26] * p4);
+        }
+    }
+
+    static const char* sampleText() {
+        return
+            "It was the best of times for the small trading house on the corner of the market "
+            "square. Every morning the clerks arrived before the sun had cleared the rooftops, "
+            "opened the heavy ledgers and began to record the business of the day. There were "
+            "letters to answer, accounts to settle and shipments to check against the orders "
+            "that had been sent out weeks before. The senior partner believed that nothing "
+            "mattered more than the trust of the people they dealt with, and he would often "
+            "remind the younger men that a single careless mistake could undo the work of many "
+            "years. When a message had to travel between the house and its agents in other "
+            "cities, it was written out by hand, read twice, and then sealed before it left the "
+            "building. Some of those letters carried information that would have been valuable "
+            "to a rival, such as the price the house was willing to pay for grain or the name of "
+            "a ship that would arrive early in the spring. For that reason the partners agreed "
+            "that the most important details should be hidden in a simple cipher which only "
+            "their own people could read. The method was not perfect, and they knew that a "
+            "patient enemy with enough time might be able to break it, but it was good enough "
+            "to protect their plans from the casual eyes of a courier or a curious innkeeper. "
+            "In the evening, when the shop was quiet, the youngest clerk would sit by the "
+            "window and practise writing the secret letters until he could do it without "
+            "thinking. He learned that the strength of the system depended on the key, and "
+            "that the key must never be written down where another person might find it. Over "
+            "the years the house grew larger and opened offices in several other towns. The "
+            "old cipher was replaced by a better one, and then by another, as each new method "
+            "was found to have some weakness that a clever reader could exploit. The people who "
+            "worked there came to understand that security is not a thing that can be finished "
+            "once and then forgotten. It has to be watched and improved for as long as there is "
+            "anything worth protecting. Many years later, when the founder had long since "
+            "retired, a visitor asked him what he was most proud of. He thought about the "
+            "question for a while and then said that he was proud of the people who had worked "
+            "with him, because they had always done their best and had always told each other "
+            "the truth. The rest, he said, was only numbers in a book, and numbers can always be "
+            "counted again. The visitor wrote these words in his notebook and later shared them "
+            "with his own students, who had come to study how information moves through the "
+            "world and how it can be kept safe along the way. They discussed the history of "
+            "secret writing from the earliest times, when generals would send orders to their "
+            "armies in the field, through the great machines of the last century, to the modern "
+            "methods that protect the messages we send every day without even noticing. Each of "
+            "these steps was made by people who looked carefully at what had come before and "
+            "asked how it could be made stronger, faster and easier to use.";
+    }
+};
+
+#endif
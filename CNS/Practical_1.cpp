@@ -2,84 +2,244 @@
 
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include "NgramScore.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <stdlib.h>
+#include <string.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define CNS_X86_SIMD 1
+#endif
 using namespace std;
 
 // Hill Cipher functions
-static int determinant2x2(const vector<vector<int>>& matrix) {
-    return (matrix[0][0] * matrix[1][1] - matrix[0][1] * matrix[1][0]) % 26;
-}
-
+// Extended Euclid; returns -1 when gcd(a, m) != 1.
 static int modInverse(int a, int m) {
     a = ((a % m) + m) % m;
-    for (int x = 1; x < m; x++) {
-        if ((a * x) % m == 1) return x;
+    int r0 = m, r1 = a, t0 = 0, t1 = 1;
+    while (r1 != 0) {
+        int q = r0 / r1;
+        int r = r0 - q * r1; r0 = r1; r1 = r;
+        int t = t0 - q * t1; t0 = t1; t1 = t;
     }
-    return -1;
+    if (r0 != 1) return -1;
+    return ((t0 % m) + m) % m;
 }
 
-static vector<vector<int>> inverse2x2(const vector<vector<int>>& matrix) {
-    int det = determinant2x2(matrix);
-    int detInv = modInverse(det, 26);
-    if (detInv == -1) return {{-1, -1}, {-1, -1}};
-    
-    vector<vector<int>> inv(2, vector<int>(2));
-    inv[0][0] = (matrix[1][1] * detInv) % 26;
-    inv[0][1] = (-matrix[0][1] * detInv % 26 + 26) % 26;
-    inv[1][0] = (-matrix[1][0] * detInv % 26 + 26) % 26;
-    inv[1][1] = (matrix[0][0] * detInv) % 26;
-    
-    return inv;
+// Hill engine limits: keys up to 64x64, and a batch of blocks is staged in
+// HILL_BATCH_CELLS planar letters so the scratch fits on the stack / in L1.
+static const int HILL_MAX_N = 64;
+static const int HILL_BATCH_CELLS = 4096;
+
+// Flatten an N x N key into row-major form reduced to 0..25.
+static bool flattenHillKey(const vector<vector<int>>& key, vector<int>& flat) {
+    int n = key.size();
+    if (n < 1 || n > HILL_MAX_N) return false;
+    flat.assign(n * n, 0);
+    for (int i = 0; i < n; i++) {
+        if ((int)key[i].size() != n) return false;
+        for (int j = 0; j < n; j++) {
+            flat[i * n + j] = ((key[i][j] % 26) + 26) % 26;
+        }
+    }
+    return true;
 }
 
-static string prepareHillMessage(const string& message) {
-    string cleaned;
-    for (char c : message) {
-        if (isalpha(c)) {
-            cleaned += toupper(c);
+// Gauss-Jordan inverse of an n x n matrix over GF(p), p prime.
+static bool invertMatrixModPrime(const vector<int>& a, int n, int p, vector<int>& inv) {
+    static thread_local vector<int> m;
+    m.resize(n * n);
+    for (int i = 0; i < n * n; i++) m[i] = a[i] % p;
+    inv.assign(n * n, 0);
+    for (int i = 0; i < n; i++) inv[i * n + i] = 1;
+
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        while (pivot < n && m[pivot * n + col] == 0) pivot++;
+        if (pivot == n) return false;
+        if (pivot != col) {
+            swap_ranges(m.begin() + pivot * n, m.begin() + pivot * n + n, m.begin() + col * n);
+            swap_ranges(inv.begin() + pivot * n, inv.begin() + pivot * n + n, inv.begin() + col * n);
+        }
+        int pinv = modInverse(m[col * n + col], p);
+        for (int j = 0; j < n; j++) {
+            m[col * n + j] = m[col * n + j] * pinv % p;
+            inv[col * n + j] = inv[col * n + j] * pinv % p;
+        }
+        for (int r = 0; r < n; r++) {
+            int f = m[r * n + col];
+            if (r == col || f == 0) continue;
+            for (int j = 0; j < n; j++) {
+                m[r * n + j] = (m[r * n + j] + (p - f) * m[col * n + j]) % p;
+                inv[r * n + j] = (inv[r * n + j] + (p - f) * inv[col * n + j]) % p;
+            }
+        }
+    }
+    return true;
+}
+
+// Inverse mod 26 = inverse mod 2 and mod 13 glued together by CRT:
+// x = 13*a + 14*b (mod 26) satisfies x = a (mod 2) and x = b (mod 13).
+// O(n^3), so 16x16 keys invert in microseconds.
+static bool inverseHillKey(const vector<int>& key, int n, vector<int>& inv) {
+    static thread_local vector<int> inv2, inv13;
+    if (!invertMatrixModPrime(key, n, 2, inv2)) return false;
+    if (!invertMatrixModPrime(key, n, 13, inv13)) return false;
+    inv.resize(n * n);
+    for (int i = 0; i < n * n; i++) {
+        inv[i] = (13 * inv2[i] + 14 * inv13[i]) % 26;
+    }
+    return true;
+}
+
+bool isHillKeyInvertible(const vector<vector<int>>& key) {
+    vector<int> flat, inv;
+    return flattenHillKey(key, flat) && inverseHillKey(flat, key.size(), inv);
+}
+
+// Batched Hill kernel: out = K * P (mod 26) for `blocks` consecutive N-letter
+// blocks; out may equal in. Each batch is transposed into planar lanes (lane j holds letter j
+// of every block), so one key row times the batch is a multiply-add over
+// contiguous uint16 columns that the compiler vectorizes. Sums stay below
+// 64 * 25 * 25 < 65536, so reduction mod 26 happens once per output letter.
+static void hillKernel(const char* in, char* out, size_t blocks, const int* key, int n) {
+    uint8_t lanes[HILL_BATCH_CELLS];
+    uint16_t acc[HILL_BATCH_CELLS];
+    size_t batch = HILL_BATCH_CELLS / n;
+
+    for (size_t b0 = 0; b0 < blocks; b0 += batch) {
+        size_t cnt = min(batch, blocks - b0);
+        const char* src = in + b0 * n;
+        char* dst = out + b0 * n;
+
+        for (size_t b = 0; b < cnt; b++)
+            for (int j = 0; j < n; j++)
+                lanes[j * cnt + b] = (uint8_t)(src[b * n + j] - 'A');
+
+        for (int i = 0; i < n; i++) {
+            const int* row = key + i * n;
+            for (size_t b = 0; b < cnt; b++) acc[b] = 0;
+            for (int j = 0; j < n; j++) {
+                uint16_t k = (uint16_t)row[j];
+                const uint8_t* lane = lanes + j * cnt;
+                for (size_t b = 0; b < cnt; b++) acc[b] += k * lane[b];
+            }
+            for (size_t b = 0; b < cnt; b++)
+                dst[b * n + i] = (char)(acc[b] % 26 + 'A');
         }
     }
-    if (cleaned.length() % 2 != 0) {
-        cleaned += 'X';
+}
+
+// Below this many letters per worker, thread start-up costs more than it saves.
+static const size_t HILL_MIN_PARALLEL_CHUNK = 1 << 16;
+
+// Split the blocks into contiguous block-aligned chunks, one per worker.
+// Every worker writes its own slice of the presized output, so the result
+// is byte-identical to a single hillKernel call.
+static void hillKernelParallel(const char* in, char* out, size_t blocks, const int* key, int n, unsigned threads) {
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    size_t maxWorkers = max<size_t>(1, blocks * n / HILL_MIN_PARALLEL_CHUNK);
+    if (threads > maxWorkers) threads = maxWorkers;
+    if (threads <= 1) {
+        hillKernel(in, out, blocks, key, n);
+        return;
     }
+
+    vector<thread> workers;
+    size_t per = (blocks + threads - 1) / threads;
+    for (size_t first = 0; first < blocks; first += per) {
+        size_t cnt = min(per, blocks - first);
+        workers.emplace_back(hillKernel, in + first * n, out + first * n, cnt, key, n);
+    }
+    for (auto& w : workers) w.join();
+}
+
+// Uppercase letters only, padded with 'X' to a multiple of n. Writes into
+// `out`, which needs room for message.size() + n - 1 bytes; returns the length.
+static size_t prepareHillMessage(string_view message, int n, char* out) {
+    size_t len = 0;
+    for (char c : message) {
+        // ASCII letter test and uppercase without the locale calls
+        unsigned idx = (unsigned char)((c | 0x20) - 'a');
+        out[len] = (char)('A' + idx);
+        len += idx < 26;
+    }
+    while (len % n != 0) {
+        out[len++] = 'X';
+    }
+    return len;
+}
+
+static string prepareHillMessage(const string& message, int n = 2) {
+    string cleaned(message.size() + n - 1, '\0');
+    cleaned.resize(prepareHillMessage(message, n, &cleaned[0]));
     return cleaned;
 }
 
+// Works for any N x N key (N <= HILL_MAX_N); the message is padded with 'X'
+// to a whole number of N-letter blocks.
 string HillCipher(const string& message, const vector<vector<int>>& key) {
-    string prepared = prepareHillMessage(message);
-    string cipher;
-    
-    for (size_t i = 0; i < prepared.length(); i += 2) {
-        int p1 = prepared[i] - 'A';
-        int p2 = prepared[i + 1] - 'A';
-        
-        int c1 = (key[0][0] * p1 + key[0][1] * p2) % 26;
-        int c2 = (key[1][0] * p1 + key[1][1] * p2) % 26;
-        
-        cipher += (char)(c1 + 'A');
-        cipher += (char)(c2 + 'A');
-    }
-    
+    vector<int> flat;
+    if (!flattenHillKey(key, flat)) return "Invalid key matrix!";
+    int n = key.size();
+
+    string cipher = prepareHillMessage(message, n);
+    hillKernel(cipher.data(), &cipher[0], cipher.size() / n, flat.data(), n);
     return cipher;
 }
 
 string HillDecipher(const string& cipher, const vector<vector<int>>& key) {
-    vector<vector<int>> invKey = inverse2x2(key);
-    if (invKey[0][0] == -1) return "Key not invertible!";
-    
-    string plain;
-    
-    for (size_t i = 0; i < cipher.length(); i += 2) {
-        int c1 = cipher[i] - 'A';
-        int c2 = cipher[i + 1] - 'A';
-        
-        int p1 = (invKey[0][0] * c1 + invKey[0][1] * c2) % 26;
-        int p2 = (invKey[1][0] * c1 + invKey[1][1] * c2) % 26;
-        
-        plain += (char)(p1 + 'A');
-        plain += (char)(p2 + 'A');
-    }
-    
+    vector<int> flat, invKey;
+    if (!flattenHillKey(key, flat)) return "Invalid key matrix!";
+    int n = key.size();
+    if (!inverseHillKey(flat, n, invKey)) return "Key not invertible!";
+
+    size_t blocks = cipher.length() / n;
+    string plain(blocks * n, '\0');
+    hillKernel(cipher.data(), &plain[0], blocks, invKey.data(), n);
+    return plain;
+}
+
+// Parallel variants: same output as HillCipher/HillDecipher, with the block
+// multiply spread over `threads` workers (0 = all hardware threads).
+string HillCipherParallel(const string& message, const vector<vector<int>>& key, unsigned threads = 0) {
+    vector<int> flat;
+    if (!flattenHillKey(key, flat)) return "Invalid key matrix!";
+    int n = key.size();
+
+    string cipher = prepareHillMessage(message, n);
+    hillKernelParallel(cipher.data(), &cipher[0], cipher.size() / n, flat.data(), n, threads);
+    return cipher;
+}
+
+string HillDecipherParallel(const string& cipher, const vector<vector<int>>& key, unsigned threads = 0) {
+    vector<int> flat, invKey;
+    if (!flattenHillKey(key, flat)) return "Invalid key matrix!";
+    int n = key.size();
+    if (!inverseHillKey(flat, n, invKey)) return "Key not invertible!";
+
+    size_t blocks = cipher.length() / n;
+    string plain(blocks * n, '\0');
+    hillKernelParallel(cipher.data(), &plain[0], blocks, invKey.data(), n, threads);
     return plain;
 }
 
@@ -109,232 +269,1382 @@ static void buildKeyMatrix(const string &key, char keyMat[5][5]) {
     }
 }
 
-// O(1) lookup position in matrix
-static inline void findPos(const char keyMat[5][5], char ch, int &r, int &c) {
+// Key-specific digraph tables. Letters are numbered 0..24 over the Playfair
+// alphabet (J folded into I); enc/dec[a * 25 + b] holds the output pair for
+// the input digraph (a, b), so the same-row / same-column / rectangle rules
+// are resolved once per key instead of once per digraph.
+struct PlayfairTables {
+    uint8_t index[256];
+    char enc[625][2];
+    char dec[625][2];
+};
+
+static void buildPlayfairTables(const char keyMat[5][5], PlayfairTables &t) {
+    int row[25], col[25];
     for (int i = 0; i < 5; i++)
-        for (int j = 0; j < 5; j++)
-            if (keyMat[i][j] == ch) {
-                r = i; c = j;
-                return;
+        for (int j = 0; j < 5; j++) {
+            int k = keyMat[i][j] - 'A';
+            k -= (k >= 9);
+            row[k] = i; col[k] = j;
+        }
+
+    // Anything that is not a letter maps to X, which keeps lookups in range.
+    for (int c = 0; c < 256; c++) t.index[c] = 'X' - 'A' - 1;
+    for (int k = 0; k < 26; k++) {
+        int idx = k - (k >= 9);
+        t.index['A' + k] = idx;
+        t.index['a' + k] = idx;
+    }
+
+    for (int a = 0; a < 25; a++) {
+        for (int b = 0; b < 25; b++) {
+            int r1 = row[a], c1 = col[a], r2 = row[b], c2 = col[b];
+            char *e = t.enc[a * 25 + b], *d = t.dec[a * 25 + b];
+            if (r1 == r2) {
+                e[0] = keyMat[r1][(c1 + 1) % 5]; e[1] = keyMat[r2][(c2 + 1) % 5];
+                d[0] = keyMat[r1][(c1 + 4) % 5]; d[1] = keyMat[r2][(c2 + 4) % 5];
+            }
+            else if (c1 == c2) {
+                e[0] = keyMat[(r1 + 1) % 5][c1]; e[1] = keyMat[(r2 + 1) % 5][c2];
+                d[0] = keyMat[(r1 + 4) % 5][c1]; d[1] = keyMat[(r2 + 4) % 5][c2];
             }
+            else {
+                e[0] = d[0] = keyMat[r1][c2];
+                e[1] = d[1] = keyMat[r2][c1];
+            }
+        }
+    }
 }
 
-// Prepare plaintext: uppercase, J→I, insert X between duplicates & pad
-static string prepareMessage(const string &msg) {
-    string tmp;
-    tmp.reserve(msg.size());
-    for (char ch : msg) {
-        if (!isalpha(ch)) continue;
-        ch = toupper(ch);
-        if (ch == 'J') ch = 'I';
-        tmp += ch;
+// One table load per digraph; `len` must be even and out may equal in.
+static void playfairTransform(const char table[625][2], const uint8_t index[256],
+                              const char *in, char *out, size_t len) {
+    for (size_t i = 0; i < len; i += 2) {
+        const char *p = table[index[(uint8_t)in[i]] * 25 + index[(uint8_t)in[i + 1]]];
+        out[i] = p[0];
+        out[i + 1] = p[1];
     }
+}
 
-    string out;
-    out.reserve(tmp.size()+1);
-    for (size_t i = 0; i < tmp.size(); i++) {
-        out += tmp[i];
-        if (i+1 < tmp.size() && tmp[i] == tmp[i+1])
-            out += 'X';
+// Prepare plaintext: uppercase, J→I, insert X between duplicates & pad.
+// Writes into `out` (room for 2 * msg.size() + 1 bytes); returns the length.
+static size_t prepareMessage(string_view msg, char *out) {
+    size_t len = 0;
+    char prev = 0;
+    for (char c : msg) {
+        unsigned idx = (unsigned char)((c | 0x20) - 'a');
+        if (idx >= 26) continue;
+        char ch = idx == 'J' - 'A' ? 'I' : (char)('A' + idx);
+        if (ch == prev) out[len++] = 'X';
+        out[len++] = ch;
+        prev = ch;
     }
-    if (out.size() % 2) out += 'X';
-    return out;
+    if (len % 2) out[len++] = 'X';
+    return len;
 }
 
 string PlayfairCipher(const string &message, const string &key) {
     char keyMat[5][5];
     buildKeyMatrix(key, keyMat);
+    PlayfairTables tables;
+    buildPlayfairTables(keyMat, tables);
 
-    string msg = prepareMessage(message);
-    string cipher;
-    cipher.reserve(msg.size());
-
-    for (size_t i = 0; i < msg.size(); i += 2) {
-        int r1,c1,r2,c2;
-        findPos(keyMat, msg[i],   r1, c1);
-        findPos(keyMat, msg[i+1], r2, c2);
-
-        if (r1 == r2) {
-            cipher += keyMat[r1][(c1 + 1) % 5];
-            cipher += keyMat[r2][(c2 + 1) % 5];
-        }
-        else if (c1 == c2) {
-            cipher += keyMat[(r1 + 1) % 5][c1];
-            cipher += keyMat[(r2 + 1) % 5][c2];
-        }
-        else {
-            cipher += keyMat[r1][c2];
-            cipher += keyMat[r2][c1];
-        }
-    }
+    string cipher(2 * message.size() + 1, '\0');
+    cipher.resize(prepareMessage(message, &cipher[0]));
+    playfairTransform(tables.enc, tables.index, cipher.data(), &cipher[0], cipher.size());
     return cipher;
 }
 
 string PlayfairDecipher(const string &cipher, const string &key) {
     char keyMat[5][5];
     buildKeyMatrix(key, keyMat);
+    PlayfairTables tables;
+    buildPlayfairTables(keyMat, tables);
 
-    string plain;
-    plain.reserve(cipher.size());
+    string plain(cipher.size() & ~(size_t)1, '\0');
+    playfairTransform(tables.dec, tables.index, cipher.data(), &plain[0], plain.size());
+    return plain;
+}
 
-    for (size_t i = 0; i < cipher.size(); i += 2) {
-        int r1,c1,r2,c2;
-        findPos(keyMat, cipher[i],   r1, c1);
-        findPos(keyMat, cipher[i+1], r2, c2);
+// Playfair cryptanalysis: independent simulated-annealing restarts run on a
+// pool of worker threads. Each worker owns its key square and decrypt buffer,
+// so scoring a candidate key allocates nothing.
+struct PlayfairCrackResult {
+    string key;              // 25-letter key square, row by row
+    string plaintext;
+    double score = -1e300;
+    uint64_t keysTried = 0;
+    double seconds = 0;
+};
 
+// Decrypt Playfair-alphabet letters (0..24) under `grid` (position -> letter)
+// and `pos` (letter -> position) into plain alphabet indices (0..25).
+static void playfairDecryptIndices(const uint8_t grid[25], const uint8_t pos[25],
+                                   const uint8_t *in, uint8_t *out, size_t n) {
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        int p1 = pos[in[i]], p2 = pos[in[i + 1]];
+        int r1 = p1 / 5, c1 = p1 % 5, r2 = p2 / 5, c2 = p2 % 5;
+        int o1, o2;
         if (r1 == r2) {
-            plain += keyMat[r1][(c1 + 4) % 5];
-            plain += keyMat[r2][(c2 + 4) % 5];
+            o1 = r1 * 5 + (c1 + 4) % 5; o2 = r2 * 5 + (c2 + 4) % 5;
         }
         else if (c1 == c2) {
-            plain += keyMat[(r1 + 4) % 5][c1];
-            plain += keyMat[(r2 + 4) % 5][c2];
+            o1 = (r1 + 4) % 5 * 5 + c1; o2 = (r2 + 4) % 5 * 5 + c2;
         }
         else {
-            plain += keyMat[r1][c2];
-            plain += keyMat[r2][c1];
+            o1 = r1 * 5 + c2; o2 = r2 * 5 + c1;
         }
+        out[i] = grid[o1] + (grid[o1] >= 9);
+        out[i + 1] = grid[o2] + (grid[o2] >= 9);
     }
-    return plain;
+}
+
+// Mostly single letter swaps, with occasional row/column swaps and flips.
+static void mutatePlayfairKey(uint8_t grid[25], mt19937 &rng) {
+    int a = rng() % 5, b = rng() % 5;
+    switch (rng() % 50) {
+        case 0:
+            for (int j = 0; j < 5; j++) swap(grid[a * 5 + j], grid[b * 5 + j]);
+            break;
+        case 1:
+            for (int i = 0; i < 5; i++) swap(grid[i * 5 + a], grid[i * 5 + b]);
+            break;
+        case 2:
+            reverse(grid, grid + 25);
+            break;
+        case 3:
+            for (int i = 0; i < 2; i++)
+                for (int j = 0; j < 5; j++) swap(grid[i * 5 + j], grid[(4 - i) * 5 + j]);
+            break;
+        case 4:
+            for (int i = 0; i < 5; i++) reverse(grid + i * 5, grid + i * 5 + 5);
+            break;
+        default:
+            swap(grid[rng() % 25], grid[rng() % 25]);
+    }
+}
+
+// Search for the key of `cipher` with `restarts` annealing runs of `steps`
+// candidate keys each, spread over `threads` workers (0 = all cores).
+// Progress (best key so far, keys/second) is printed when `verbose`.
+PlayfairCrackResult crackPlayfair(const string &cipher, unsigned restarts = 8, unsigned threads = 0,
+                                  long steps = 1000000, bool verbose = true) {
+    vector<uint8_t> text;
+    for (char ch : cipher) {
+        if (!isalpha(ch)) continue;
+        int k = toupper(ch) - 'A';
+        text.push_back(k - (k >= 9));
+    }
+    if (text.size() % 2) text.pop_back();
+
+    PlayfairCrackResult best;
+    if (text.size() < 4) return best;
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+    threads = min(threads, max(1u, restarts));
+
+    const NgramScorer &scorer = NgramScorer::english();
+    const double startTemp = 10 + 0.087 * ((double)text.size() - 84);
+    atomic<unsigned> nextRestart(0);
+    atomic<uint64_t> tried(0);
+    mutex bestLock;
+    auto t0 = chrono::steady_clock::now();
+
+    auto worker = [&]() {
+        vector<uint8_t> plain(text.size());
+        uint8_t parent[25], child[25], pos[25];
+        for (unsigned r; (r = nextRestart++) < restarts; ) {
+            mt19937 rng(0x9E3779B9u * (r + 1));
+            for (int i = 0; i < 25; i++) parent[i] = i;
+            shuffle(parent, parent + 25, rng);
+            for (int i = 0; i < 25; i++) pos[parent[i]] = i;
+            playfairDecryptIndices(parent, pos, text.data(), plain.data(), text.size());
+            double parentScore = scorer.score(plain.data(), plain.size());
+            double localBest = parentScore;
+            uint8_t localKey[25];
+            copy(parent, parent + 25, localKey);
+            uniform_real_distribution<double> unit(0.0, 1.0);
+
+            for (long step = 0; step < steps; step++) {
+                double temp = max(startTemp, 1.0) * (1.0 - (double)step / steps);
+                copy(parent, parent + 25, child);
+                mutatePlayfairKey(child, rng);
+                for (int i = 0; i < 25; i++) pos[child[i]] = i;
+                playfairDecryptIndices(child, pos, text.data(), plain.data(), text.size());
+                double s = scorer.score(plain.data(), plain.size());
+                double d = s - parentScore;
+                if (d >= 0 || (temp > 0 && exp(d / temp) > unit(rng))) {
+                    copy(child, child + 25, parent);
+                    parentScore = s;
+                    if (s > localBest) {
+                        localBest = s;
+                        copy(child, child + 25, localKey);
+                    }
+                }
+            }
+            tried += steps;
+
+            lock_guard<mutex> guard(bestLock);
+            if (localBest > best.score) {
+                best.score = localBest;
+                best.key.assign(25, ' ');
+                for (int i = 0; i < 25; i++) best.key[i] = 'A' + localKey[i] + (localKey[i] >= 9);
+                if (verbose) {
+                    double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+                    cout << "\n[restart " << r << "] best score " << localBest << ", key " << best.key
+                         << ", " << (uint64_t)(tried / max(secs, 1e-9)) << " keys/s";
+                }
+            }
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned i = 0; i < threads; i++) pool.emplace_back(worker);
+    for (auto &t : pool) t.join();
+
+    best.keysTried = tried;
+    best.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    best.plaintext = PlayfairDecipher(cipher, best.key);
+    if (verbose) {
+        cout << "\nTried " << best.keysTried << " keys in " << best.seconds << " s ("
+             << (uint64_t)(best.keysTried / max(best.seconds, 1e-9)) << " keys/s on "
+             << threads << " threads)";
+    }
+    return best;
+}
+
+// Monoalphabetic substitution kernel. Every monoalphabetic cipher reduces to
+// a 26-entry table `tab` (padded to 32 bytes): a letter with alphabet index i
+// becomes base + tab[i], where base is 'A' or 'a' to keep the input's case;
+// everything else passes through. The SIMD versions classify 16/32 bytes at
+// once with masks and look the table up with two PSHUFBs (SSE2 has no byte
+// shuffle, so the 128-bit path needs SSSE3). In-place use (in == out) is fine.
+static void monoSubstituteScalar(const uint8_t tab[32], const char *in, char *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned char ch = in[i];
+        unsigned idx = (unsigned char)((ch | 0x20) - 'a');
+        out[i] = idx < 26 ? (char)(tab[idx] + (ch & 0x20) + 'A') : (char)ch;
+    }
+}
+
+#ifdef CNS_X86_SIMD
+__attribute__((target("ssse3")))
+static void monoSubstituteSSSE3(const uint8_t tab[32], const char *in, char *out, size_t n) {
+    const __m128i lo = _mm_loadu_si128((const __m128i *)tab);
+    const __m128i hi = _mm_loadu_si128((const __m128i *)(tab + 16));
+    const __m128i caseMask = _mm_set1_epi8(0x20), a = _mm_set1_epi8('a'), A = _mm_set1_epi8('A');
+    const __m128i k15 = _mm_set1_epi8(15), k16 = _mm_set1_epi8(16), k25 = _mm_set1_epi8(25);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i caseBit = _mm_and_si128(v, caseMask);
+        __m128i idx = _mm_sub_epi8(_mm_or_si128(v, caseMask), a);
+        __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(idx, k25), idx);
+        __m128i useHi = _mm_cmpgt_epi8(idx, k15);
+        __m128i r = _mm_or_si128(_mm_and_si128(useHi, _mm_shuffle_epi8(hi, _mm_sub_epi8(idx, k16))),
+                                 _mm_andnot_si128(useHi, _mm_shuffle_epi8(lo, idx)));
+        r = _mm_add_epi8(_mm_add_epi8(r, A), caseBit);
+        r = _mm_or_si128(_mm_and_si128(isLetter, r), _mm_andnot_si128(isLetter, v));
+        _mm_storeu_si128((__m128i *)(out + i), r);
+    }
+    monoSubstituteScalar(tab, in + i, out + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void monoSubstituteAVX2(const uint8_t tab[32], const char *in, char *out, size_t n) {
+    const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)tab));
+    const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(tab + 16)));
+    const __m256i caseMask = _mm256_set1_epi8(0x20), a = _mm256_set1_epi8('a'), A = _mm256_set1_epi8('A');
+    const __m256i k15 = _mm256_set1_epi8(15), k16 = _mm256_set1_epi8(16), k25 = _mm256_set1_epi8(25);
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i caseBit = _mm256_and_si256(v, caseMask);
+        __m256i idx = _mm256_sub_epi8(_mm256_or_si256(v, caseMask), a);
+        __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(idx, k25), idx);
+        __m256i useHi = _mm256_cmpgt_epi8(idx, k15);
+        __m256i r = _mm256_blendv_epi8(_mm256_shuffle_epi8(lo, idx),
+                                       _mm256_shuffle_epi8(hi, _mm256_sub_epi8(idx, k16)), useHi);
+        r = _mm256_add_epi8(_mm256_add_epi8(r, A), caseBit);
+        r = _mm256_blendv_epi8(v, r, isLetter);
+        _mm256_storeu_si256((__m256i *)(out + i), r);
+    }
+    monoSubstituteSSSE3(tab, in + i, out + i, n - i);
+}
+#endif
+
+typedef void (*MonoKernel)(const uint8_t *, const char *, char *, size_t);
+
+static MonoKernel selectMonoKernel() {
+#ifdef CNS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return monoSubstituteAVX2;
+    if (__builtin_cpu_supports("ssse3")) return monoSubstituteSSSE3;
+#endif
+    return monoSubstituteScalar;
+}
+
+static void monoSubstitute(const uint8_t tab[32], const char *in, char *out, size_t n) {
+    static const MonoKernel kernel = selectMonoKernel();
+    kernel(tab, in, out, n);
+}
+
+static string applyMonoTable(const uint8_t tab[32], const string &text) {
+    string out(text.size(), '\0');
+    monoSubstitute(tab, text.data(), &out[0], text.size());
+    return out;
+}
+
+// Tables are filled with the same formulas the ciphers used per character,
+// so the output is unchanged for every key.
+static void caesarTable(int key, bool decrypt, uint8_t tab[32]) {
+    for (int i = 0; i < 32; i++)
+        tab[i] = i < 26 ? (uint8_t)(decrypt ? (i - key + 26) % 26 : (i + key) % 26) : 0;
+}
+
+static void affineTable(int key1, int key2, bool decrypt, uint8_t tab[32]) {
+    int key1_inv = decrypt ? modInverse(key1, 26) : 0;
+    for (int i = 0; i < 32; i++)
+        tab[i] = i < 26 ? (uint8_t)(decrypt ? (key1_inv * (i - key2 + 26)) % 26 : (key1 * i + key2) % 26) : 0;
+}
+
+// Arbitrary monoalphabetic key: alphabet[i] is the substitute for letter i.
+// Returns false unless alphabet is a permutation of the 26 letters.
+static bool substitutionTable(const string &alphabet, bool decrypt, uint8_t tab[32]) {
+    if (alphabet.size() != 26) return false;
+    bool seen[26] = {};
+    fill(tab, tab + 32, 0);
+    for (int i = 0; i < 26; i++) {
+        if (!isalpha(alphabet[i])) return false;
+        int k = toupper(alphabet[i]) - 'A';
+        if (seen[k]) return false;
+        seen[k] = true;
+        if (decrypt) tab[k] = i;
+        else tab[i] = k;
+    }
+    return true;
+}
+
+string substitutionCipher(const string &message, const string &alphabet) {
+    uint8_t tab[32];
+    if (!substitutionTable(alphabet, false, tab)) return "Invalid substitution alphabet!";
+    return applyMonoTable(tab, message);
+}
+
+string substitutionDecipher(const string &cipher_text, const string &alphabet) {
+    uint8_t tab[32];
+    if (!substitutionTable(alphabet, true, tab)) return "Invalid substitution alphabet!";
+    return applyMonoTable(tab, cipher_text);
 }
 
 // Caesar Cipher functions
 string encipherCeaserCipher(string message, int key){
-    string cipher_text = "";
-    for (int i = 0; i < message.length(); i++ ){
-        char ch = message[i];
-        if (isalpha(ch)) {
-            char base = isupper(ch) ? 'A' : 'a';
-            ch = (ch - base + key) % 26 + base; // shift by key
+    uint8_t tab[32];
+    caesarTable(key, false, tab); // shift by key
+    return applyMonoTable(tab, message);
+}
+
+string decipherCeaserCipher(string cipher_text, int key){
+    uint8_t tab[32];
+    caesarTable(key, true, tab);
+    return applyMonoTable(tab, cipher_text);
+}
+
+// Polyalphabetic engine for Vigenere and classic Vernam. The key is expanded
+// once into per-position shifts (0..25) and required letter cases, tiled to
+// period + POLY_TILE bytes so a SIMD lane group can always load a contiguous
+// slice; the phase wraps once per vector instead of `i % key.length()` per
+// character. Positions the fast path cannot express exactly (a letter whose
+// case differs from the key letter, or a non-letter Vigenere key character)
+// are handed to the original per-character formula, so output is unchanged.
+static const size_t POLY_TILE = 32;
+static const uint8_t POLY_ANY_CASE = 0xFF;  // key char not a letter: Vernam passes through
+static const uint8_t POLY_NO_FAST = 0x40;   // never matches a case bit: always slow path
+
+enum PolyCipher { POLY_VIGENERE, POLY_VERNAM };
+
+struct PolyShifts {
+    size_t period = 0;
+    vector<uint8_t> shift;
+    vector<uint8_t> caseReq;
+};
+
+static void buildPolyShifts(string_view key, PolyCipher kind, bool decrypt, PolyShifts &ps) {
+    ps.period = key.size();
+    ps.shift.resize(ps.period + POLY_TILE);
+    ps.caseReq.resize(ps.period + POLY_TILE);
+    for (size_t t = 0; t < ps.shift.size(); t++) {
+        char k = key[t % ps.period];
+        if (isalpha(k)) {
+            int s = (k | 0x20) - 'a';
+            ps.shift[t] = decrypt ? (26 - s) % 26 : s;
+            ps.caseReq[t] = k & 0x20;
+        } else {
+            ps.shift[t] = 0;
+            ps.caseReq[t] = kind == POLY_VERNAM ? POLY_ANY_CASE : POLY_NO_FAST;
         }
-        cipher_text += ch;
     }
-    return cipher_text;
 }
 
-string decipherCeaserCipher(string cipher_text, int key){
-    string message = "";
-    for(int i = 0; i < cipher_text.length(); i++){
-        char ch = cipher_text[i];
-        if(isalpha(ch)){
-            char base = isupper(ch)? 'A' : 'a';
-            ch = (ch - base - key + 26) % 26 + base;
+// Fast path over [i, n); returns the first position it could not handle
+// (left unwritten, so in == out is safe), or n.
+static size_t polyKernelScalar(const PolyShifts &ps, const char *in, char *out, size_t i, size_t n) {
+    size_t j = i % ps.period;
+    for (; i < n; i++) {
+        unsigned char ch = in[i];
+        unsigned idx = (unsigned char)((ch | 0x20) - 'a');
+        if (idx < 26) {
+            uint8_t req = ps.caseReq[j];
+            if (req != POLY_ANY_CASE && req != (ch & 0x20)) return i;
+            unsigned t = idx + ps.shift[j];
+            if (t >= 26) t -= 26;
+            out[i] = (char)(t + 'A' + (ch & 0x20));
+        } else {
+            out[i] = (char)ch;
         }
-        message += ch;
+        if (++j == ps.period) j = 0;
     }
-    return message;
+    return n;
 }
 
-// Vigenère Cipher functions
-string encipherVinereCipher(string message, string key){
-    string cipher_text = "";
-    for(int i = 0; i < message.length(); i++){
-        char ch = message[i];
-        char k = key[i % key.length()];
-        if (isalpha(ch)){
+#ifdef CNS_X86_SIMD
+static size_t polyKernelSSE2(const PolyShifts &ps, const char *in, char *out, size_t i, size_t n) {
+    const __m128i caseMask = _mm_set1_epi8(0x20), a = _mm_set1_epi8('a'), A = _mm_set1_epi8('A');
+    const __m128i k25 = _mm_set1_epi8(25), k26 = _mm_set1_epi8(26), any = _mm_set1_epi8((char)POLY_ANY_CASE);
+    size_t j = i % ps.period;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        __m128i s = _mm_loadu_si128((const __m128i *)(ps.shift.data() + j));
+        __m128i req = _mm_loadu_si128((const __m128i *)(ps.caseReq.data() + j));
+        __m128i caseBit = _mm_and_si128(v, caseMask);
+        __m128i idx = _mm_sub_epi8(_mm_or_si128(v, caseMask), a);
+        __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(idx, k25), idx);
+        __m128i ok = _mm_or_si128(_mm_cmpeq_epi8(req, any), _mm_cmpeq_epi8(req, caseBit));
+        __m128i t = _mm_add_epi8(idx, s);
+        t = _mm_sub_epi8(t, _mm_and_si128(_mm_cmpeq_epi8(_mm_max_epu8(t, k26), t), k26));
+        t = _mm_add_epi8(_mm_add_epi8(t, A), caseBit);
+        int slow = _mm_movemask_epi8(_mm_andnot_si128(ok, isLetter));
+        if (slow) return polyKernelScalar(ps, in, out, i, i + 16);
+        _mm_storeu_si128((__m128i *)(out + i), _mm_or_si128(_mm_and_si128(isLetter, t), _mm_andnot_si128(isLetter, v)));
+        j += 16;
+        if (j >= ps.period) j %= ps.period;
+    }
+    return polyKernelScalar(ps, in, out, i, n);
+}
+
+__attribute__((target("avx2")))
+static size_t polyKernelAVX2(const PolyShifts &ps, const char *in, char *out, size_t i, size_t n) {
+    const __m256i caseMask = _mm256_set1_epi8(0x20), a = _mm256_set1_epi8('a'), A = _mm256_set1_epi8('A');
+    const __m256i k25 = _mm256_set1_epi8(25), k26 = _mm256_set1_epi8(26), any = _mm256_set1_epi8((char)POLY_ANY_CASE);
+    size_t j = i % ps.period;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(in + i));
+        __m256i s = _mm256_loadu_si256((const __m256i *)(ps.shift.data() + j));
+        __m256i req = _mm256_loadu_si256((const __m256i *)(ps.caseReq.data() + j));
+        __m256i caseBit = _mm256_and_si256(v, caseMask);
+        __m256i idx = _mm256_sub_epi8(_mm256_or_si256(v, caseMask), a);
+        __m256i isLetter = _mm256_cmpeq_epi8(_mm256_min_epu8(idx, k25), idx);
+        __m256i ok = _mm256_or_si256(_mm256_cmpeq_epi8(req, any), _mm256_cmpeq_epi8(req, caseBit));
+        __m256i t = _mm256_add_epi8(idx, s);
+        t = _mm256_sub_epi8(t, _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(t, k26), t), k26));
+        t = _mm256_add_epi8(_mm256_add_epi8(t, A), caseBit);
+        unsigned slow = (unsigned)_mm256_movemask_epi8(_mm256_andnot_si256(ok, isLetter));
+        if (slow) return polyKernelScalar(ps, in, out, i, i + 32);
+        _mm256_storeu_si256((__m256i *)(out + i), _mm256_blendv_epi8(v, t, isLetter));
+        j += 32;
+        if (j >= ps.period) j %= ps.period;
+    }
+    return polyKernelSSE2(ps, in, out, i, n);
+}
+#endif
+
+typedef size_t (*PolyKernel)(const PolyShifts &, const char *, char *, size_t, size_t);
+
+static PolyKernel selectPolyKernel() {
+#ifdef CNS_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return polyKernelAVX2;
+    return polyKernelSSE2;
+#else
+    return polyKernelScalar;
+#endif
+}
+
+// The original per-character formulas. Returns false where the Vigenere
+// functions used to stop (message and key letters in different cases).
+static bool polyStep(PolyCipher kind, bool decrypt, char &ch, char k) {
+    if (kind == POLY_VIGENERE) {
+        if (isalpha(ch)) {
             char msg_base = isupper(ch)? 'A' : 'a';
             char key_base = isupper(k)? 'A' : 'a';
-            if(key_base == msg_base){
-                ch = (ch - msg_base + (k - key_base)) % 26 + msg_base;
-            }
-            else{
-                cout<<"\nMessage and key should be in the same case!";
-                break;
-            }
+            if (key_base != msg_base) return false;
+            ch = decrypt ? ((ch - msg_base - (k - key_base)) + 26) % 26 + msg_base
+                         : (ch - msg_base + (k - key_base)) % 26 + msg_base;
+        }
+    } else if (isalpha(ch) && isalpha(k)) {
+        char base = isupper(ch) ? 'A' : 'a';
+        ch = decrypt ? (ch - base - (k - base) + 26) % 26 + base
+                     : (ch - base + (k - base)) % 26 + base;
+    }
+    return true;
+}
+
+// Runs the cipher with an already expanded key; shared by polyTransform and
+// the prepared VigenereKey/VernamKey objects.
+static size_t polyRun(const PolyShifts &ps, string_view text, string_view key, PolyCipher kind, bool decrypt, char *out) {
+    static const PolyKernel kernel = selectPolyKernel();
+    size_t i = 0;
+    while ((i = kernel(ps, text.data(), out, i, text.size())) < text.size()) {
+        char ch = text[i];
+        if (!polyStep(kind, decrypt, ch, key[i % key.size()])) {
+            cerr<<"\nMessage and key should be in the same case!";
+            return i;
         }
-        cipher_text += ch;
-    } 
-    return cipher_text;
+        out[i++] = ch;
+    }
+    return text.size();
+}
+
+// Writes up to text.size() bytes to `out` (which may alias text) and returns
+// the output length, which is shorter only where Vigenere stops on a case
+// mismatch. The expanded key lives in per-thread scratch, so repeated calls
+// do not allocate once it has grown to the largest key seen.
+static size_t polyTransform(string_view text, string_view key, PolyCipher kind, bool decrypt, char *out) {
+    if (key.empty()) {
+        copy(text.begin(), text.end(), out);
+        return text.size();
+    }
+    static thread_local PolyShifts ps;
+    buildPolyShifts(key, kind, decrypt, ps);
+    return polyRun(ps, text, key, kind, decrypt, out);
+}
+
+static string polyTransform(const string &text, const string &key, PolyCipher kind, bool decrypt) {
+    string out(text.size(), '\0');
+    out.resize(polyTransform(text, key, kind, decrypt, &out[0]));
+    return out;
+}
+
+// Per-character reference (the pre-engine code path), kept for timing.
+static string polyReference(const string &text, const string &key, PolyCipher kind, bool decrypt) {
+    string out;
+    for (size_t i = 0; i < text.size(); i++) {
+        char ch = text[i];
+        if (!polyStep(kind, decrypt, ch, key[i % key.length()])) break;
+        out += ch;
+    }
+    return out;
+}
+
+// Time the reference loop against the engine on `bytes` of random text.
+void reportPolyalphabeticSpeedup(size_t bytes = 100u << 20) {
+    mt19937 rng(42);
+    string text(bytes, ' '), key = "LEMONADE";
+    for (char &ch : text) {
+        unsigned r = rng() % 32;
+        ch = r < 26 ? (char)('A' + r) : ' ';
+    }
+    const char *names[2] = {"Vigenere", "Vernam"};
+    for (int kind = POLY_VIGENERE; kind <= POLY_VERNAM; kind++) {
+        auto t0 = chrono::steady_clock::now();
+        string slow = polyReference(text, key, (PolyCipher)kind, false);
+        auto t1 = chrono::steady_clock::now();
+        string fast = polyTransform(text, key, (PolyCipher)kind, false);
+        auto t2 = chrono::steady_clock::now();
+        double ts = chrono::duration<double>(t1 - t0).count(), tf = chrono::duration<double>(t2 - t1).count();
+        double mb = bytes / 1048576.0;
+        cout << "\n" << names[kind] << " on " << mb << " MB: reference " << mb / ts << " MB/s, engine "
+             << mb / tf << " MB/s, speedup " << ts / tf << "x" << (slow == fast ? "" : " (OUTPUT MISMATCH)");
+    }
+}
+
+// Vigenère Cipher functions
+string encipherVinereCipher(string message, string key){
+    return polyTransform(message, key, POLY_VIGENERE, false);
 }
 
 string decipherVinereCipher(string cipher, string key){
-    string plain_text = "";
-    for(int i = 0; i < cipher.length(); i++){
-        char ch = cipher[i];
-        char k = key[i % key.length()];
-        if (isalpha(ch)){
-            char msg_base = isupper(ch)? 'A' : 'a';
-            char key_base = isupper(k)? 'A' : 'a';
-            if(key_base == msg_base){
-                ch = ((ch - msg_base - (k - key_base )) + 26) % 26 + msg_base;
+    return polyTransform(cipher, key, POLY_VIGENERE, true);
+}
+
+// Vigenere cryptanalysis. The key advances on every character (letters or
+// not), so column c of period p is every position i with i % p == c.
+// 1. Autocorrelation: the fraction of letters equal to the letter s places
+//    later peaks (~0.066 for English vs ~0.038 random) when s is a multiple
+//    of the period; computed with SIMD byte compares over a sample.
+// 2. Index of coincidence of the columns confirms the smallest such period.
+// 3. Column histograms over the whole text are built in parallel chunks and
+//    each column's Caesar shift is the one with the lowest chi-squared.
+struct VigenereCrackResult {
+    string key;
+    size_t period = 0;
+    double ioc = 0;        // mean column index of coincidence at `period`
+    double seconds = 0;
+};
+
+static const double ENGLISH_FREQ[26] = {
+    0.08167, 0.01492, 0.02782, 0.04253, 0.12702, 0.02228, 0.02015, 0.06094, 0.06966,
+    0.00153, 0.00772, 0.04025, 0.02406, 0.06749, 0.07507, 0.01929, 0.00095, 0.05987,
+    0.06327, 0.09056, 0.02758, 0.00978, 0.02360, 0.00150, 0.01974, 0.00074
+};
+
+static const size_t VIGENERE_SAMPLE = 1 << 20;   // bytes used to find the period
+
+// Letters become 0..25, everything else 0xFF.
+static void letterIndices(const char *in, uint8_t *out, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned idx = (unsigned char)((in[i] | 0x20) - 'a');
+        out[i] = idx < 26 ? idx : 0xFF;
+    }
+}
+
+// Number of i with t[i] == t[i + s] and t[i] a letter.
+static size_t countCoincidences(const uint8_t *t, size_t n, size_t s) {
+    size_t count = 0, i = 0;
+#ifdef CNS_X86_SIMD
+    const __m128i k25 = _mm_set1_epi8(25);
+    for (; i + s + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i *)(t + i));
+        __m128i b = _mm_loadu_si128((const __m128i *)(t + i + s));
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(_mm_min_epu8(a, k25), a));
+        count += __builtin_popcount(_mm_movemask_epi8(hit));
+    }
+#endif
+    for (; i + s < n; i++) count += (t[i] == t[i + s]) & (t[i] < 26);
+    return count;
+}
+
+// Per-column letter histograms hist[c * 26 + letter] for period p over
+// text[begin, end). Consecutive characters land in different columns, so the
+// increments do not form a store-to-load dependency chain.
+static void columnHistograms(const char *text, size_t begin, size_t end, size_t p, vector<uint64_t> &hist) {
+    hist.assign(p * 26, 0);
+    size_t col = begin % p;
+    for (size_t i = begin; i < end; i++) {
+        unsigned idx = (unsigned char)((text[i] | 0x20) - 'a');
+        if (idx < 26) hist[col * 26 + idx]++;
+        if (++col == p) col = 0;
+    }
+}
+
+VigenereCrackResult crackVigenere(const string &cipher, size_t maxPeriod = 40, unsigned threads = 0) {
+    VigenereCrackResult res;
+    auto t0 = chrono::steady_clock::now();
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+    size_t sampleLen = min(cipher.size(), VIGENERE_SAMPLE);
+    vector<uint8_t> sample(sampleLen);
+    letterIndices(cipher.data(), sample.data(), sampleLen);
+    size_t letters = count_if(sample.begin(), sample.end(), [](uint8_t c) { return c < 26; });
+    if (letters < 2) return res;
+    maxPeriod = max<size_t>(1, min(maxPeriod, sampleLen / 2));
+
+    // 1. autocorrelation for every shift
+    vector<double> kappa(maxPeriod + 1, 0.0);
+    double bestKappa = 0;
+    for (size_t s = 1; s <= maxPeriod; s++) {
+        kappa[s] = (double)countCoincidences(sample.data(), sampleLen, s) / letters;
+        bestKappa = max(bestKappa, kappa[s]);
+    }
+
+    // 2. smallest strongly correlated period with an English-like column IoC
+    vector<uint64_t> hist;
+    double bestIoc = -1;
+    for (size_t p = 1; p <= maxPeriod; p++) {
+        if (p > 1 && kappa[p] < 0.8 * bestKappa) continue;
+        columnHistograms(cipher.data(), 0, sampleLen, p, hist);
+        double ioc = 0;
+        size_t cols = 0;
+        for (size_t c = 0; c < p; c++) {
+            uint64_t n = 0, pairs = 0;
+            for (int k = 0; k < 26; k++) {
+                n += hist[c * 26 + k];
+                pairs += hist[c * 26 + k] * (hist[c * 26 + k] - (hist[c * 26 + k] > 0));
             }
-            else{
-                cout<<"\nMessage and key should be in the same case!";
-                break;
+            if (n > 1) { ioc += (double)pairs / (n * (n - 1)); cols++; }
+        }
+        if (cols) ioc /= cols;
+        if (ioc > bestIoc + 0.005) {
+            bestIoc = ioc;
+            res.period = p;
+        }
+        if (ioc >= 0.06) break;
+    }
+    res.ioc = bestIoc;
+    size_t p = res.period;
+
+    // 3. histograms over the whole text, one chunk per worker, then merge
+    unsigned workers = (unsigned)min<size_t>(threads, max<size_t>(1, cipher.size() / (1 << 16)));
+    vector<vector<uint64_t>> partial(workers);
+    vector<thread> pool;
+    size_t per = (cipher.size() + workers - 1) / workers;
+    for (unsigned w = 0; w < workers; w++) {
+        size_t begin = min(cipher.size(), w * per), end = min(cipher.size(), begin + per);
+        pool.emplace_back(columnHistograms, cipher.data(), begin, end, p, ref(partial[w]));
+    }
+    for (auto &t : pool) t.join();
+    for (unsigned w = 1; w < workers; w++)
+        for (size_t k = 0; k < p * 26; k++) partial[0][k] += partial[w][k];
+
+    // Key letters take the case of the first letter: the functions above
+    // need message and key letters in the same case.
+    char base = 'A';
+    for (char ch : cipher) if (isalpha(ch)) { base = isupper(ch) ? 'A' : 'a'; break; }
+
+    res.key.assign(p, base);
+    const vector<uint64_t> &h = partial[0];
+    for (size_t c = 0; c < p; c++) {
+        uint64_t n = 0;
+        for (int k = 0; k < 26; k++) n += h[c * 26 + k];
+        double bestChi = 1e300;
+        for (int shift = 0; shift < 26 && n > 0; shift++) {
+            double chi = 0;
+            for (int k = 0; k < 26; k++) {
+                double expect = n * ENGLISH_FREQ[k];
+                double d = h[c * 26 + (k + shift) % 26] - expect;
+                chi += d * d / expect;
+            }
+            if (chi < bestChi) {
+                bestChi = chi;
+                res.key[c] = base + shift;
             }
         }
-        plain_text += ch;
-    } 
-    return plain_text;
+    }
+    res.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    return res;
 }
 
 // Affine Cipher functions
 string affineCipher(string message, int key1, int key2) {
-    string cipher_text = "";
-    for (int i = 0; i < message.length(); i++ ){
-        char ch = message[i];
-        if (isalpha(ch)) {
-            char base = isupper(ch) ? 'A' : 'a';
-            ch = (key1 * (ch - base) + key2) % 26 + base; // apply affine formula
-        }
-        cipher_text += ch;
-    }
-    return cipher_text;
+    uint8_t tab[32];
+    affineTable(key1, key2, false, tab); // apply affine formula
+    return applyMonoTable(tab, message);
 }
 
 string affineDecipher(string cipher_text, int key1, int key2) {
-    string message = "";
-    int key1_inv = modInverse(key1, 26); // find modular inverse of key1
-    for (int i = 0; i < cipher_text.length(); i++ ){
-        char ch = cipher_text[i];
-        if (isalpha(ch)) {
-            char base = isupper(ch) ? 'A' : 'a';
-            ch = (key1_inv * ((ch - base) - key2 + 26)) % 26 + base; // apply inverse affine formula
-        }
-        message += ch;
-    }
-    return message;
+    uint8_t tab[32];
+    affineTable(key1, key2, true, tab); // inverse formula with modInverse(key1, 26)
+    return applyMonoTable(tab, cipher_text);
 }
 
 // Vernam Cipher functions
 string classicVernamCipher(string message, string key) {
-    string cipher_text = "";
-    for (size_t i = 0; i < message.length(); i++) {
-        char ch = message[i];
-        char k = key[i % key.length()]; // repeat key as necessary
-        if (isalpha(ch) && isalpha(k)) {
-            char base = isupper(ch) ? 'A' : 'a';
-            ch = (ch - base + (k - base)) % 26 + base;
+    return polyTransform(message, key, POLY_VERNAM, false); // repeat key as necessary
+}
+
+string classicVernamDecipher(string cipher_text, string key) {
+    return polyTransform(cipher_text, key, POLY_VERNAM, true);
+}
+
+// Allocation-free API. Each cipher also takes an input view and a caller
+// buffer (same size as the input unless noted) and returns the number of
+// bytes written; the length-preserving ciphers have in-place variants. No
+// call allocates, apart from per-thread scratch growing to the largest key.
+size_t encipherCeaserCipher(string_view message, char *out, int key) {
+    uint8_t tab[32];
+    caesarTable(key, false, tab);
+    monoSubstitute(tab, message.data(), out, message.size());
+    return message.size();
+}
+
+size_t decipherCeaserCipher(string_view cipher_text, char *out, int key) {
+    uint8_t tab[32];
+    caesarTable(key, true, tab);
+    monoSubstitute(tab, cipher_text.data(), out, cipher_text.size());
+    return cipher_text.size();
+}
+
+size_t affineCipher(string_view message, char *out, int key1, int key2) {
+    uint8_t tab[32];
+    affineTable(key1, key2, false, tab);
+    monoSubstitute(tab, message.data(), out, message.size());
+    return message.size();
+}
+
+size_t affineDecipher(string_view cipher_text, char *out, int key1, int key2) {
+    uint8_t tab[32];
+    affineTable(key1, key2, true, tab);
+    monoSubstitute(tab, cipher_text.data(), out, cipher_text.size());
+    return cipher_text.size();
+}
+
+// Returns 0 (nothing written) for an invalid alphabet.
+size_t substitutionCipher(string_view message, char *out, const string &alphabet) {
+    uint8_t tab[32];
+    if (!substitutionTable(alphabet, false, tab)) return 0;
+    monoSubstitute(tab, message.data(), out, message.size());
+    return message.size();
+}
+
+size_t substitutionDecipher(string_view cipher_text, char *out, const string &alphabet) {
+    uint8_t tab[32];
+    if (!substitutionTable(alphabet, true, tab)) return 0;
+    monoSubstitute(tab, cipher_text.data(), out, cipher_text.size());
+    return cipher_text.size();
+}
+
+size_t encipherVinereCipher(string_view message, char *out, string_view key) {
+    return polyTransform(message, key, POLY_VIGENERE, false, out);
+}
+
+size_t decipherVinereCipher(string_view cipher, char *out, string_view key) {
+    return polyTransform(cipher, key, POLY_VIGENERE, true, out);
+}
+
+size_t classicVernamCipher(string_view message, char *out, string_view key) {
+    return polyTransform(message, key, POLY_VERNAM, false, out);
+}
+
+size_t classicVernamDecipher(string_view cipher_text, char *out, string_view key) {
+    return polyTransform(cipher_text, key, POLY_VERNAM, true, out);
+}
+
+void encipherCeaserCipherInPlace(char *buf, size_t len, int key) {
+    encipherCeaserCipher(string_view(buf, len), buf, key);
+}
+
+void decipherCeaserCipherInPlace(char *buf, size_t len, int key) {
+    decipherCeaserCipher(string_view(buf, len), buf, key);
+}
+
+void affineCipherInPlace(char *buf, size_t len, int key1, int key2) {
+    affineCipher(string_view(buf, len), buf, key1, key2);
+}
+
+void affineDecipherInPlace(char *buf, size_t len, int key1, int key2) {
+    affineDecipher(string_view(buf, len), buf, key1, key2);
+}
+
+bool substitutionCipherInPlace(char *buf, size_t len, const string &alphabet) {
+    return substitutionCipher(string_view(buf, len), buf, alphabet) == len;
+}
+
+bool substitutionDecipherInPlace(char *buf, size_t len, const string &alphabet) {
+    return substitutionDecipher(string_view(buf, len), buf, alphabet) == len;
+}
+
+// Vigenere returns the processed length (shorter on a case mismatch).
+size_t encipherVinereCipherInPlace(char *buf, size_t len, string_view key) {
+    return encipherVinereCipher(string_view(buf, len), buf, key);
+}
+
+size_t decipherVinereCipherInPlace(char *buf, size_t len, string_view key) {
+    return decipherVinereCipher(string_view(buf, len), buf, key);
+}
+
+void classicVernamCipherInPlace(char *buf, size_t len, string_view key) {
+    classicVernamCipher(string_view(buf, len), buf, key);
+}
+
+void classicVernamDecipherInPlace(char *buf, size_t len, string_view key) {
+    classicVernamDecipher(string_view(buf, len), buf, key);
+}
+
+// Playfair: `out` needs room for 2 * message.size() + 1 bytes when
+// enciphering (X insertion), cipher.size() when deciphering.
+size_t PlayfairCipher(string_view message, char *out, const string &key) {
+    char keyMat[5][5];
+    buildKeyMatrix(key, keyMat);
+    PlayfairTables tables;
+    buildPlayfairTables(keyMat, tables);
+
+    size_t len = prepareMessage(message, out);
+    playfairTransform(tables.enc, tables.index, out, out, len);
+    return len;
+}
+
+size_t PlayfairDecipher(string_view cipher, char *out, const string &key) {
+    char keyMat[5][5];
+    buildKeyMatrix(key, keyMat);
+    PlayfairTables tables;
+    buildPlayfairTables(keyMat, tables);
+
+    size_t len = cipher.size() & ~(size_t)1;
+    playfairTransform(tables.dec, tables.index, cipher.data(), out, len);
+    return len;
+}
+
+// Hill: `out` needs room for message.size() + N - 1 bytes when enciphering.
+// Returns 0 for an invalid (or, deciphering, non-invertible) key.
+size_t HillCipher(string_view message, char *out, const vector<vector<int>>& key) {
+    static thread_local vector<int> flat;
+    if (!flattenHillKey(key, flat)) return 0;
+    int n = key.size();
+
+    size_t len = prepareHillMessage(message, n, out);
+    hillKernel(out, out, len / n, flat.data(), n);
+    return len;
+}
+
+size_t HillDecipher(string_view cipher, char *out, const vector<vector<int>>& key) {
+    static thread_local vector<int> flat, invKey;
+    if (!flattenHillKey(key, flat)) return 0;
+    int n = key.size();
+    if (!inverseHillKey(flat, n, invKey)) return 0;
+
+    size_t blocks = cipher.length() / n;
+    hillKernel(cipher.data(), out, blocks, invKey.data(), n);
+    return blocks * n;
+}
+
+// Prepared keys. Each object validates its key and builds the tables once, so
+// repeated calls with the same key skip the per-call setup (key matrix, pair
+// tables, matrix inverse, expanded Vigenere shifts). Buffer rules and return
+// values match the allocation-free functions above; the string overloads
+// return the same messages as the string functions for an unusable key.
+
+// Table pair shared by the single-table keys. Inherited privately, so a key
+// is never usable through another key type; each one exposes or wraps
+// encrypt/decrypt itself.
+class MonoTableKey {
+public:
+    size_t encrypt(string_view message, char *out) const { return run(enc, message, out); }
+    size_t decrypt(string_view cipher, char *out) const { return run(dec, cipher, out); }
+    string encrypt(const string &message) const { return applyMonoTable(enc, message); }
+    string decrypt(const string &cipher) const { return applyMonoTable(dec, cipher); }
+
+protected:
+    static size_t run(const uint8_t *tab, string_view in, char *out) {
+        monoSubstitute(tab, in.data(), out, in.size());
+        return in.size();
+    }
+    uint8_t enc[32], dec[32];
+};
+
+class CaesarKey : private MonoTableKey {
+public:
+    explicit CaesarKey(int key) {
+        caesarTable(key, false, enc);
+        caesarTable(key, true, dec);
+    }
+    using MonoTableKey::encrypt;
+    using MonoTableKey::decrypt;
+};
+
+class AffineKey : private MonoTableKey {
+public:
+    AffineKey(int key1, int key2) : ok(modInverse(key1, 26) != -1) {
+        affineTable(key1, key2, false, enc);
+        affineTable(key1, key2, true, dec);
+    }
+    using MonoTableKey::encrypt;
+    using MonoTableKey::decrypt;
+    // key1 must be coprime with 26 for the cipher to be reversible.
+    bool valid() const { return ok; }
+
+private:
+    bool ok;
+};
+
+class SubstitutionKey : private MonoTableKey {
+public:
+    explicit SubstitutionKey(const string &alphabet)
+        : ok(substitutionTable(alphabet, false, enc) && substitutionTable(alphabet, true, dec)) {}
+    bool valid() const { return ok; }
+    size_t encrypt(string_view message, char *out) const { return ok ? run(enc, message, out) : 0; }
+    size_t decrypt(string_view cipher, char *out) const { return ok ? run(dec, cipher, out) : 0; }
+    string encrypt(const string &message) const { return ok ? applyMonoTable(enc, message) : "Invalid substitution alphabet!"; }
+    string decrypt(const string &cipher) const { return ok ? applyMonoTable(dec, cipher) : "Invalid substitution alphabet!"; }
+
+private:
+    bool ok;
+};
+
+class VigenereKey {
+public:
+    explicit VigenereKey(string key) : VigenereKey(move(key), POLY_VIGENERE) {}
+    size_t encrypt(string_view message, char *out) const { return run(enc, false, message, out); }
+    size_t decrypt(string_view cipher, char *out) const { return run(dec, true, cipher, out); }
+    string encrypt(const string &message) const { return runString(enc, false, message); }
+    string decrypt(const string &cipher) const { return runString(dec, true, cipher); }
+
+private:
+    size_t run(const PolyShifts &ps, bool decrypt, string_view text, char *out) const {
+        if (key.empty()) {
+            copy(text.begin(), text.end(), out);
+            return text.size();
         }
-        cipher_text += ch;
+        return polyRun(ps, text, key, kind, decrypt, out);
+    }
+    string runString(const PolyShifts &ps, bool decrypt, const string &text) const {
+        string result(text.size(), '\0');
+        result.resize(run(ps, decrypt, text, &result[0]));
+        return result;
     }
-    return cipher_text;
+
+protected:
+    VigenereKey(string key, PolyCipher kind) : key(move(key)), kind(kind) {
+        if (this->key.empty()) return;   // passes text through, as polyTransform does
+        buildPolyShifts(this->key, kind, false, enc);
+        buildPolyShifts(this->key, kind, true, dec);
+    }
+
+private:
+    string key;
+    PolyCipher kind;
+    PolyShifts enc, dec;
+};
+
+// Same engine with the Vernam shift rule; private so it is not a VigenereKey.
+class VernamKey : private VigenereKey {
+public:
+    explicit VernamKey(string key) : VigenereKey(move(key), POLY_VERNAM) {}
+    using VigenereKey::encrypt;
+    using VigenereKey::decrypt;
+};
+
+class PlayfairKey {
+public:
+    explicit PlayfairKey(const string &key) : tables(new PlayfairTables) {
+        char keyMat[5][5];
+        buildKeyMatrix(key, keyMat);
+        buildPlayfairTables(keyMat, *tables);
+    }
+    size_t encrypt(string_view message, char *out) const {
+        size_t len = prepareMessage(message, out);
+        playfairTransform(tables->enc, tables->index, out, out, len);
+        return len;
+    }
+    size_t decrypt(string_view cipher, char *out) const {
+        size_t len = cipher.size() & ~(size_t)1;
+        playfairTransform(tables->dec, tables->index, cipher.data(), out, len);
+        return len;
+    }
+    string encrypt(const string &message) const {
+        string cipher(2 * message.size() + 1, '\0');
+        cipher.resize(encrypt(string_view(message), &cipher[0]));
+        return cipher;
+    }
+    string decrypt(const string &cipher) const {
+        string plain(cipher.size(), '\0');
+        plain.resize(decrypt(string_view(cipher), &plain[0]));
+        return plain;
+    }
+
+private:
+    shared_ptr<PlayfairTables> tables;   // ~5 KB; copies share it
+};
+
+class HillKey {
+public:
+    explicit HillKey(const vector<vector<int>> &key)
+        : n(key.size()), ok(flattenHillKey(key, flat)), invertible(ok && inverseHillKey(flat, n, inv)) {}
+    bool valid() const { return ok; }
+    bool isInvertible() const { return invertible; }
+    int size() const { return n; }
+
+    // `threads` as for HillCipherParallel; 1 keeps the multiply on this thread.
+    size_t encrypt(string_view message, char *out, unsigned threads = 1) const {
+        if (!ok) return 0;
+        size_t len = prepareHillMessage(message, n, out);
+        multiply(out, out, len / n, flat, threads);
+        return len;
+    }
+    size_t decrypt(string_view cipher, char *out, unsigned threads = 1) const {
+        if (!invertible) return 0;
+        size_t blocks = cipher.size() / n;
+        multiply(cipher.data(), out, blocks, inv, threads);
+        return blocks * n;
+    }
+    string encrypt(const string &message, unsigned threads = 1) const {
+        if (!ok) return "Invalid key matrix!";
+        string cipher(message.size() + n - 1, '\0');
+        cipher.resize(encrypt(string_view(message), &cipher[0], threads));
+        return cipher;
+    }
+    string decrypt(const string &cipher, unsigned threads = 1) const {
+        if (!ok) return "Invalid key matrix!";
+        if (!invertible) return "Key not invertible!";
+        string plain(cipher.size(), '\0');
+        plain.resize(decrypt(string_view(cipher), &plain[0], threads));
+        return plain;
+    }
+
+private:
+    void multiply(const char *in, char *out, size_t blocks, const vector<int> &k, unsigned threads) const {
+        if (threads == 1) hillKernel(in, out, blocks, k.data(), n);
+        else hillKernelParallel(in, out, blocks, k.data(), n, threads);
+    }
+    int n;
+    vector<int> flat, inv;
+    bool ok, invertible;
+};
+
+// File mode for Caesar, Affine, Vigenere, Vernam and Hill. The input is
+// mmapped FILE_CHUNK bytes at a time (page aligned, MADV_SEQUENTIAL) and the
+// cipher writes straight into an mmapped, presized output, so a large file
+// is never copied into user-space buffers and only a couple of chunks are
+// resident at once. If outPath names the input file the length-preserving
+// ciphers work in place. Without mmap (_WIN32) chunks go through one stdio buffer.
+// All functions return false if a file cannot be opened, mapped or written.
+static const size_t FILE_CHUNK = 8u << 20;   // multiple of any page size
+
+// Transforms n bytes starting at file offset `offset`; out may equal in.
+// Returns the number of bytes produced (less than n stops the file there).
+using FileChunkFn = function<size_t(const char *in, char *out, size_t n, size_t offset)>;
+
+// Letter index 0..25, or >= 26 for anything else: the same ASCII-only test
+// as prepareHillMessage, so the file and string Hill paths agree on letters.
+static unsigned hillLetter(char c) {
+    return (unsigned char)((c | 0x20) - 'a');
 }
 
-string classicVernamDecipher(string cipher_text, string key) {
-    string message = "";
-    for (size_t i = 0; i < cipher_text.length(); i++) {
-        char ch = cipher_text[i];
-        char k = key[i % key.length()]; // repeat key as necessary
-        if (isalpha(ch) && isalpha(k)) {
-            char base = isupper(ch) ? 'A' : 'a';
-            ch = (ch - base - (k - base) + 26) % 26 + base;
+#ifndef _WIN32
+struct FileDescriptor {
+    int fd;
+    explicit FileDescriptor(int f) : fd(f) {}
+    ~FileDescriptor() { if (fd >= 0) close(fd); }
+};
+
+struct FileMapping {
+    char *data = nullptr;
+    size_t len = 0;
+    FileMapping(int fd, size_t offset, size_t n, bool writable) : len(n) {
+        void *p = mmap(nullptr, n, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, offset);
+        if (p == MAP_FAILED) return;
+        data = (char *)p;
+        madvise(p, n, MADV_SEQUENTIAL);
+    }
+    ~FileMapping() { if (data) munmap(data, len); }
+};
+
+// The output is opened without O_TRUNC and compared with the input by
+// device and inode, so a link or a second spelling of the input path is
+// detected before anything is truncated.
+static bool sameFile(const struct stat &a, int fd) {
+    struct stat b;
+    return fstat(fd, &b) == 0 && a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+static bool transformFile(const string &inPath, const string &outPath, const FileChunkFn &fn) {
+    FileDescriptor in(open(inPath.c_str(), O_RDONLY));
+    struct stat st;
+    if (in.fd < 0 || fstat(in.fd, &st) != 0) return false;
+    FileDescriptor out(open(outPath.c_str(), O_RDWR | O_CREAT, 0644));
+    if (out.fd < 0) return false;
+    bool inPlace = sameFile(st, out.fd);
+    int outFd = out.fd;
+    size_t size = st.st_size;
+    if (!inPlace && ftruncate(outFd, size) != 0) return false;
+
+    for (size_t off = 0; off < size; off += FILE_CHUNK) {
+        size_t len = min(FILE_CHUNK, size - off), done;
+        if (inPlace) {
+            FileMapping buf(outFd, off, len, true);
+            if (!buf.data) return false;
+            done = fn(buf.data, buf.data, len, off);
+        } else {
+            FileMapping src(in.fd, off, len, false), dst(outFd, off, len, true);
+            if (!src.data || !dst.data) return false;
+            done = fn(src.data, dst.data, len, off);
+        }
+        if (done < len) {
+            int rc = ftruncate(outFd, off + done);   // output stops where the cipher did
+            (void)rc;
+            return false;
         }
-        message += ch;
     }
-    return message;
+    return true;
+}
+
+// Hill output is the input's letters (padded with 'X' when enciphering), so
+// a counting pass sizes the output first. Letters are then compacted into a
+// mapped output window and complete blocks are multiplied in place; a block
+// cut by the window end is picked up again by the next window, which starts
+// at the page holding the first unprocessed letter.
+static bool hillFile(const string &inPath, const string &outPath, const vector<int> &key, int n, bool decrypt) {
+    FileDescriptor in(open(inPath.c_str(), O_RDONLY));
+    struct stat st;
+    if (in.fd < 0 || fstat(in.fd, &st) != 0) return false;
+    size_t size = st.st_size, letters = 0;
+    for (size_t off = 0; off < size; off += FILE_CHUNK) {
+        FileMapping src(in.fd, off, min(FILE_CHUNK, size - off), false);
+        if (!src.data) return false;
+        for (size_t i = 0; i < src.len; i++) letters += hillLetter(src.data[i]) < 26;
+    }
+    size_t outSize = decrypt ? letters / n * n : (letters + n - 1) / n * n;
+
+    FileDescriptor out(open(outPath.c_str(), O_RDWR | O_CREAT, 0644));
+    if (out.fd < 0 || sameFile(st, out.fd) || ftruncate(out.fd, outSize) != 0) return false;
+    if (outSize == 0) return true;
+
+    const size_t page = sysconf(_SC_PAGESIZE);
+    unique_ptr<FileMapping> win;
+    size_t base = 0, pos = 0, done = 0;   // window start, letters written, letters enciphered
+    auto process = [&] {
+        size_t blocks = (pos - done) / n;
+        hillKernel(win->data + (done - base), win->data + (done - base), blocks, key.data(), n);
+        done += blocks * n;
+    };
+    auto remap = [&] {
+        if (win) process();
+        base = done / page * page;
+        win.reset();
+        win.reset(new FileMapping(out.fd, base, min(FILE_CHUNK, outSize - base), true));
+        return win->data != nullptr;
+    };
+    if (!remap()) return false;
+
+    for (size_t off = 0; off < size && pos < outSize; off += FILE_CHUNK) {
+        FileMapping src(in.fd, off, min(FILE_CHUNK, size - off), false);
+        if (!src.data) return false;
+        for (size_t i = 0; i < src.len && pos < outSize; i++) {
+            unsigned idx = hillLetter(src.data[i]);
+            if (idx >= 26) continue;
+            if (pos == base + win->len && !remap()) return false;
+            win->data[pos++ - base] = (char)('A' + idx);
+        }
+    }
+    while (pos < outSize) {
+        if (pos == base + win->len && !remap()) return false;
+        win->data[pos++ - base] = 'X';
+    }
+    process();
+    return true;
+}
+#else
+// Without inodes the two paths are compared after _fullpath, which folds
+// relative spellings and "..", case-insensitively as NTFS does.
+static bool samePath(const string &a, const string &b) {
+    char fa[_MAX_PATH], fb[_MAX_PATH];
+    if (!_fullpath(fa, a.c_str(), _MAX_PATH) || !_fullpath(fb, b.c_str(), _MAX_PATH)) return a == b;
+    return _stricmp(fa, fb) == 0;
+}
+
+static bool transformFile(const string &inPath, const string &outPath, const FileChunkFn &fn) {
+    bool inPlace = samePath(inPath, outPath);
+    FILE *in = fopen(inPath.c_str(), inPlace ? "r+b" : "rb");
+    FILE *out = inPlace ? in : fopen(outPath.c_str(), "wb");
+    bool ok = in && out;
+    vector<char> buf(ok ? FILE_CHUNK : 0);
+    for (size_t off = 0, len; ok && (len = fread(buf.data(), 1, FILE_CHUNK, in)) > 0; off += len) {
+        size_t done = fn(buf.data(), buf.data(), len, off);
+        if (inPlace) fseek(out, (long)off, SEEK_SET);
+        ok = fwrite(buf.data(), 1, done, out) == done && done == len;
+        if (inPlace) fseek(in, (long)(off + len), SEEK_SET);
+    }
+    if (out && out != in) ok = fclose(out) == 0 && ok;
+    if (in) fclose(in);
+    return ok;
+}
+
+static bool hillFile(const string &inPath, const string &outPath, const vector<int> &key, int n, bool decrypt) {
+    if (samePath(inPath, outPath)) return false;
+    FILE *in = fopen(inPath.c_str(), "rb");
+    FILE *out = fopen(outPath.c_str(), "wb");
+    bool ok = in && out;
+    vector<char> buf(ok ? FILE_CHUNK : 0), stage;
+    for (size_t len; ok && (len = fread(buf.data(), 1, FILE_CHUNK, in)) > 0;) {
+        for (size_t i = 0; i < len; i++)
+            if (hillLetter(buf[i]) < 26) stage.push_back((char)('A' + hillLetter(buf[i])));
+        size_t full = stage.size() / n * n;
+        hillKernel(stage.data(), stage.data(), full / n, key.data(), n);
+        ok = fwrite(stage.data(), 1, full, out) == full;
+        stage.erase(stage.begin(), stage.begin() + full);
+    }
+    if (ok && !decrypt && !stage.empty()) {
+        stage.resize(n, 'X');
+        hillKernel(stage.data(), stage.data(), 1, key.data(), n);
+        ok = fwrite(stage.data(), 1, n, out) == (size_t)n;
+    }
+    if (out) ok = fclose(out) == 0 && ok;
+    if (in) fclose(in);
+    return ok;
+}
+#endif
+
+bool encipherCeaserCipherFile(const string &inPath, const string &outPath, int key) {
+    uint8_t tab[32];
+    caesarTable(key, false, tab);
+    return transformFile(inPath, outPath, [&](const char *in, char *out, size_t n, size_t) {
+        monoSubstitute(tab, in, out, n);
+        return n;
+    });
+}
+
+bool decipherCeaserCipherFile(const string &inPath, const string &outPath, int key) {
+    uint8_t tab[32];
+    caesarTable(key, true, tab);
+    return transformFile(inPath, outPath, [&](const char *in, char *out, size_t n, size_t) {
+        monoSubstitute(tab, in, out, n);
+        return n;
+    });
+}
+
+bool affineCipherFile(const string &inPath, const string &outPath, int key1, int key2) {
+    uint8_t tab[32];
+    affineTable(key1, key2, false, tab);
+    return transformFile(inPath, outPath, [&](const char *in, char *out, size_t n, size_t) {
+        monoSubstitute(tab, in, out, n);
+        return n;
+    });
+}
+
+bool affineDecipherFile(const string &inPath, const string &outPath, int key1, int key2) {
+    if (modInverse(key1, 26) == -1) return false;
+    uint8_t tab[32];
+    affineTable(key1, key2, true, tab);
+    return transformFile(inPath, outPath, [&](const char *in, char *out, size_t n, size_t) {
+        monoSubstitute(tab, in, out, n);
+        return n;
+    });
+}
+
+// The key phase of each chunk is its file offset modulo the key length.
+static bool polyFile(const string &inPath, const string &outPath, const string &key, PolyCipher kind, bool decrypt) {
+    string rotated;
+    return transformFile(inPath, outPath, [&](const char *in, char *out, size_t n, size_t offset) {
+        size_t phase = key.empty() ? 0 : offset % key.size();
+        rotated.assign(key, phase, string::npos);
+        rotated.append(key, 0, phase);
+        return polyTransform(string_view(in, n), rotated, kind, decrypt, out);
+    });
+}
+
+bool encipherVinereCipherFile(const string &inPath, const string &outPath, const string &key) {
+    return polyFile(inPath, outPath, key, POLY_VIGENERE, false);
+}
+
+bool decipherVinereCipherFile(const string &inPath, const string &outPath, const string &key) {
+    return polyFile(inPath, outPath, key, POLY_VIGENERE, true);
+}
+
+bool classicVernamCipherFile(const string &inPath, const string &outPath, const string &key) {
+    return polyFile(inPath, outPath, key, POLY_VERNAM, false);
+}
+
+bool classicVernamDecipherFile(const string &inPath, const string &outPath, const string &key) {
+    return polyFile(inPath, outPath, key, POLY_VERNAM, true);
+}
+
+// Same output as HillCipher/HillDecipher on the file's contents, except that
+// deciphering also skips non-letters. outPath must differ from inPath.
+bool HillCipherFile(const string &inPath, const string &outPath, const vector<vector<int>> &key) {
+    vector<int> flat;
+    if (!flattenHillKey(key, flat)) return false;
+    return hillFile(inPath, outPath, flat, key.size(), false);
+}
+
+bool HillDecipherFile(const string &inPath, const string &outPath, const vector<vector<int>> &key) {
+    vector<int> flat, invKey;
+    if (!flattenHillKey(key, flat) || !inverseHillKey(flat, key.size(), invKey)) return false;
+    return hillFile(inPath, outPath, invKey, key.size(), true);
 }
 
 // string modifiedVernamCipher(string message, string key){
 
 // }
 
+// Define CNS_NO_MAIN to reuse the functions above from another program
+// (see Benchmark.cpp).
+#ifndef CNS_NO_MAIN
 int main() {
     int cipherType;
     cout << "=== Cipher Type Menu ===\n";
     cout << "1. Monoalphabetic Cipher\n";
     cout << "2. Polyalphabetic Cipher\n";
-    cout << "Enter choice (1-2): ";
+    cout << "3. Cryptanalysis\n";
+    cout << "4. File Encryption\n";
+    cout << "Enter choice (1-4): ";
     cin >> cipherType;
     cin.ignore(); // Clear input buffer
 
@@ -384,10 +1694,16 @@ int main() {
         cout << "2. Hill Cipher\n";
         cout << "3. Vigenere Cipher\n";
         cout << "4. Vernam Cipher\n";
-        cout << "Enter choice (1-4): ";
+        cout << "5. Vigenere/Vernam engine speedup (100 MB)\n";
+        cout << "Enter choice (1-5): ";
         cin >> choice;
         cin.ignore();
 
+        if (choice == 5) {
+            reportPolyalphabeticSpeedup();
+            return 0;
+        }
+
         string message;
         cout << "Enter the Message: ";
         getline(cin, message);
@@ -404,10 +1720,17 @@ int main() {
                 break;
             }
             case 2: {
-                vector<vector<int>> key(2, vector<int>(2));
-                cout << "Enter 2x2 key matrix:\n";
-                for (int i = 0; i < 2; i++) {
-                    for (int j = 0; j < 2; j++) {
+                int n;
+                cout << "Enter key size N (1-" << HILL_MAX_N << "): ";
+                cin >> n;
+                if (n < 1 || n > HILL_MAX_N) {
+                    cout << "Invalid key size!";
+                    break;
+                }
+                vector<vector<int>> key(n, vector<int>(n));
+                cout << "Enter " << n << "x" << n << " key matrix:\n";
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < n; j++) {
                         cout << "key[" << i << "][" << j << "]: ";
                         cin >> key[i][j];
                     }
@@ -439,11 +1762,127 @@ int main() {
                 break;
             }
             default:
-                cout << "Invalid choice! Please select 1-4.";
+                cout << "Invalid choice! Please select 1-5.";
+        }
+    } else if (cipherType == 3) {
+        int choice;
+        cout << "=== Cryptanalysis Menu ===\n";
+        cout << "1. Playfair key search\n";
+        cout << "2. Vigenere key recovery\n";
+        cout << "Enter choice (1-2): ";
+        cin >> choice;
+        cin.ignore();
+
+        string cipher;
+        cout << "Enter the Ciphertext: ";
+        getline(cin, cipher);
+
+        switch (choice) {
+            case 1: {
+                unsigned restarts, threads;
+                cout << "Number of restarts: ";
+                cin >> restarts;
+                cout << "Worker threads (0 = all cores): ";
+                cin >> threads;
+
+                PlayfairCrackResult res = crackPlayfair(cipher, restarts, threads);
+                cout << "\nRecovered key square: " << res.key;
+                cout << "\nPlaintext: " << res.plaintext;
+                break;
+            }
+            case 2: {
+                VigenereCrackResult res = crackVigenere(cipher);
+                cout << "\nPeriod: " << res.period << " (column IoC " << res.ioc << ")";
+                cout << "\nRecovered key: " << res.key;
+                cout << "\nPlaintext: " << decipherVinereCipher(cipher, res.key);
+                cout << "\nAnalysis time: " << res.seconds << " s";
+                break;
+            }
+            default:
+                cout << "Invalid choice! Please select 1-2.";
         }
+    } else if (cipherType == 4) {
+        int choice, mode;
+        cout << "=== File Encryption Menu ===\n";
+        cout << "1. Caesar Cipher\n";
+        cout << "2. Affine Cipher\n";
+        cout << "3. Vigenere Cipher\n";
+        cout << "4. Vernam Cipher\n";
+        cout << "5. Hill Cipher\n";
+        cout << "Enter choice (1-5): ";
+        cin >> choice;
+        cout << "1. Encrypt  2. Decrypt: ";
+        cin >> mode;
+        cin.ignore();
+        bool decrypt = mode == 2;
+
+        string inPath, outPath;
+        cout << "Input file: ";
+        getline(cin, inPath);
+        cout << "Output file: ";
+        getline(cin, outPath);
+
+        bool ok = false;
+        auto start = chrono::steady_clock::now();
+        switch (choice) {
+            case 1: {
+                int key;
+                cout << "Enter key (1-25): ";
+                cin >> key;
+                ok = decrypt ? decipherCeaserCipherFile(inPath, outPath, key) : encipherCeaserCipherFile(inPath, outPath, key);
+                break;
+            }
+            case 2: {
+                int key1, key2;
+                cout << "Enter key1 (multiplicative key): ";
+                cin >> key1;
+                cout << "Enter key2 (additive key): ";
+                cin >> key2;
+                ok = decrypt ? affineDecipherFile(inPath, outPath, key1 % 26, key2 % 26)
+                             : affineCipherFile(inPath, outPath, key1 % 26, key2 % 26);
+                break;
+            }
+            case 3:
+            case 4: {
+                string key;
+                cout << "Enter key: ";
+                getline(cin, key);
+                if (choice == 3)
+                    ok = decrypt ? decipherVinereCipherFile(inPath, outPath, key) : encipherVinereCipherFile(inPath, outPath, key);
+                else
+                    ok = decrypt ? classicVernamDecipherFile(inPath, outPath, key) : classicVernamCipherFile(inPath, outPath, key);
+                break;
+            }
+            case 5: {
+                int n;
+                cout << "Enter key size N (1-" << HILL_MAX_N << "): ";
+                cin >> n;
+                if (n < 1 || n > HILL_MAX_N) {
+                    cout << "Invalid key size!";
+                    return 0;
+                }
+                vector<vector<int>> key(n, vector<int>(n));
+                cout << "Enter " << n << "x" << n << " key matrix:\n";
+                for (int i = 0; i < n; i++) {
+                    for (int j = 0; j < n; j++) {
+                        cout << "key[" << i << "][" << j << "]: ";
+                        cin >> key[i][j];
+                    }
+                }
+                ok = decrypt ? HillDecipherFile(inPath, outPath, key) : HillCipherFile(inPath, outPath, key);
+                break;
+            }
+            default:
+                cout << "Invalid choice! Please select 1-5.";
+                return 0;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        if (ok) cout << "\nWrote " << outPath << " in " << seconds << " s";
+        else cout << "\nFile encryption failed!";
     } else {
-        cout << "Invalid cipher type! Please select 1-2.";
+        cout << "Invalid cipher type! Please select 1-4.";
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
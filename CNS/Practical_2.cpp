@@ -1,235 +1,700 @@
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <thread>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "NgramScore.h"
 using namespace std;
 
-string railFenceCipher(string message){
-    int len = message.length();
-    int rail = 2;
-    string cipher_text = "";
+// Buffer API: every cipher below works on an input view and writes into a
+// caller-provided buffer, returning the number of bytes written. The string
+// functions further down are thin wrappers around these. Only the columnar
+// ciphers allocate, and only when the plan cache admits a new plan.
 
-    for (int i = 0; i < rail; i++) {
-        for (int j = i; j < len; j += 2 * (rail - 1)) {
-            cipher_text += message[j];
-            if (i != 0 && i != rail - 1 && j + 2 * (rail - 1 - i) < len) {
-                cipher_text += message[j + 2 * (rail - 1 - i)];
-            }
+// Rail fence with any number of rails, starting `offset` steps into the
+// zigzag (as if that many characters came before the message). With
+// cycle = 2 * (rails - 1), position p sits on rail min(p % cycle, cycle - p % cycle),
+// so rail r holds exactly the positions congruent to r or cycle - r. The walk
+// visits those positions rail by rail in output order, one pass and no fence.
+// Position p < rails sits on rail p, so rails from offset + len up hold
+// nothing: larger rail counts are clamped to offset + len first, and rails
+// at or past `end` are skipped for the same reason.
+template <class Visit>
+static void railFenceWalk(size_t len, int rails, size_t offset, Visit visit) {
+    if (offset < (size_t)rails && len < (size_t)rails - offset)
+        rails = max<size_t>(2, offset + len);
+    size_t cycle = 2 * ((size_t)rails - 1);
+    offset %= cycle;
+    size_t end = offset + len;
+    int last = (int)min<size_t>(rails, end);
+    for (int r = 0; r < last; r++) {
+        bool middle = r != 0 && r != rails - 1;
+        for (size_t base = 0; base < end; base += cycle) {
+            size_t p = base + r;
+            if (p >= offset && p < end) visit(p - offset);
+            p = base + cycle - r;
+            if (middle && p >= offset && p < end) visit(p - offset);
         }
     }
-    return cipher_text;
 }
 
-string railFenceDecipher(string cipher_text){
-    int len = cipher_text.length();
-    int rail = 2;
-    string message = "";
-    
-    // Create a 2D vector to represent the rail fence
-    vector<vector<char>> fence(rail, vector<char>(len, '\0'));
-    
-    // Mark the positions where characters should be placed
-    bool direction_down = false;
-    int row = 0;
-    
-    for (int i = 0; i < len; i++) {
-        // Mark the position
-        fence[row][i] = '*';
-        
-        // Change direction at top and bottom rails
-        if (row == 0 || row == rail - 1) {
-            direction_down = !direction_down;
-        }
-        
-        // Move to next row
-        if (direction_down) {
-            row++;
-        } else {
-            row--;
-        }
+// Rail fence output is the same length as the input; fewer than 2 rails
+// leave the text unchanged.
+size_t railFenceCipher(string_view message, char *out, int rails = 2, size_t offset = 0){
+    if (rails < 2) {
+        copy(message.begin(), message.end(), out);
+        return message.length();
     }
-    
-    // Fill the marked positions with characters from cipher_text
-    int index = 0;
-    for (int i = 0; i < rail; i++) {
-        for (int j = 0; j < len; j++) {
-            if (fence[i][j] == '*' && index < len) {
-                fence[i][j] = cipher_text[index++];
-            }
+    size_t k = 0;
+    railFenceWalk(message.length(), rails, offset, [&](size_t i) { out[k++] = message[i]; });
+    return k;
+}
+
+// Same walk as the cipher, scattering instead of gathering.
+size_t railFenceDecipher(string_view cipher_text, char *out, int rails = 2, size_t offset = 0){
+    if (rails < 2) {
+        copy(cipher_text.begin(), cipher_text.end(), out);
+        return cipher_text.length();
+    }
+    size_t k = 0;
+    railFenceWalk(cipher_text.length(), rails, offset, [&](size_t i) { out[i] = cipher_text[k++]; });
+    return cipher_text.length();
+}
+
+// Columnar output is a full grid: rows * key.size() bytes, short rows padded
+// with spaces.
+size_t columnarOutputLength(size_t len, size_t keySize) {
+    if (keySize == 0) return 0;
+    return (len + keySize - 1) / keySize * keySize;
+}
+
+// Columnar engine: cell (r, c) of the grid is message[r * n + c] and the
+// j-th valid key column is output[j * rows, (j + 1) * rows). The grid is
+// moved one tile of COLUMNAR_TILE_BYTES worth of rows at a time, so the
+// strided side of the transpose stays in L1 and the other side is n
+// sequential streams, whatever the message size.
+static const size_t COLUMNAR_TILE_BYTES = 16 * 1024;
+
+static size_t columnarTileRows(size_t n) {
+    return max<size_t>(1, COLUMNAR_TILE_BYTES / n);
+}
+
+static size_t singleColumnarCipherDirect(string_view message, char *out, const vector<int>& key) {
+    size_t n = key.size();
+    if (n == 0) return 0;
+    size_t len = message.length();
+    size_t rows = (len + n - 1) / n; // Calculate number of rows needed
+    size_t fullRows = len / n, tile = columnarTileRows(n);
+    const char *msg = message.data();
+
+    // Complete rows: gather each key column of the tile into its output run
+    for (size_t r0 = 0; r0 < fullRows; r0 += tile) {
+        size_t count = min(tile, fullRows - r0);
+        size_t j = 0;
+        for (int c : key) {
+            if (c < 1 || (size_t)c > n) continue;
+            const char *src = msg + r0 * n + c - 1;
+            char *dst = out + j++ * rows + r0;
+            for (size_t r = 0; r < count; r++) dst[r] = src[r * n];
         }
     }
-    
-    // Read the fence in zigzag pattern to get original message
-    direction_down = false;
-    row = 0;
-    
-    for (int i = 0; i < len; i++) {
-        // Add character to result
-        message += fence[row][i];
-        
-        // Change direction at top and bottom rails
-        if (row == 0 || row == rail - 1) {
-            direction_down = !direction_down;
+    // Short last row, padded with spaces
+    size_t j = 0;
+    if (rows > fullRows) {
+        for (int c : key) {
+            if (c < 1 || (size_t)c > n) continue;
+            size_t src = fullRows * n + c - 1;
+            out[j++ * rows + fullRows] = src < len ? msg[src] : ' ';
         }
-        
-        // Move to next row
-        if (direction_down) {
-            row++;
-        } else {
-            row--;
+    } else {
+        for (int c : key) j += c >= 1 && (size_t)c <= n;
+    }
+    return j * rows;
+}
+
+static size_t singleColumnarDecipherDirect(string_view cipher, char *out, const vector<int>& key) {
+    size_t n = key.size();
+    if (n == 0) return 0;
+    size_t len = cipher.length();
+    size_t rows = (len + n - 1) / n, tile = columnarTileRows(n);
+    const char *in = cipher.data();
+
+    // Scatter each key column's run back into the tile's rows; cells with no
+    // ciphertext (skipped key entries, short input) stay spaces
+    for (size_t r0 = 0; r0 < rows; r0 += tile) {
+        size_t count = min(tile, rows - r0);
+        fill(out + r0 * n, out + (r0 + count) * n, ' ');
+        size_t j = 0;
+        for (int c : key) {
+            if (c < 1 || (size_t)c > n) continue;
+            size_t first = j++ * rows + r0;
+            if (first >= len) break;
+            const char *src = in + first;
+            char *dst = out + r0 * n + c - 1;
+            size_t m = min(count, len - first);
+            for (size_t r = 0; r < m; r++) dst[r * n] = src[r];
         }
     }
-    
-    return message;
+    return rows * n;
 }
 
+// Double transposition as one composed permutation: with R rows per pass,
+// message cell (a, b) is intermediate byte s = j * R1 + a for every key
+// position j holding column b, and intermediate byte s is output byte
+// j2 * R2 + s / n for every key position j2 holding column s % n. Nothing
+// between the passes is materialized; both directions move COLUMNAR_TILE_BYTES
+// of grid rows at a time so the strided side stays in L1, with s / n and
+// s % n advanced incrementally instead of divided.
+struct ColumnarSlots {
+    vector<int> first;   // first[c]: first key position holding column c, or -1
+    vector<int> next;    // next[j]: next key position holding the same column, or -1
+    vector<int> last;    // last[c]: last key position holding column c, or -1
+    size_t valid = 0;    // key positions holding a column in 1..n
+    bool permutation = false;   // every column exactly once
+};
 
-string singleColumnTranspositionCipher(const string& message, const vector<int>& key) {
-    int n = key.size();
-    int len = message.length();
-    int rows = (len + n - 1) / n; // Calculate number of rows needed
-    vector<string> grid(rows, string(n, ' '));
-
-    // Fill the grid
-    for (int i = 0; i < len; i++) {
-        grid[i / n][i % n] = message[i];
+// Key positions are counted over the valid entries only, as in the single
+// transposition. Lives in per-thread scratch, so repeated calls don't allocate.
+static const ColumnarSlots& columnarSlots(const vector<int>& key) {
+    static thread_local ColumnarSlots cs;
+    size_t n = key.size();
+    cs.first.assign(n, -1);
+    cs.last.assign(n, -1);
+    cs.next.assign(n, -1);
+    cs.valid = 0;
+    for (int c : key) {
+        if (c < 1 || (size_t)c > n) continue;
+        int j = cs.valid++;
+        if (cs.last[c - 1] < 0) cs.first[c - 1] = j;
+        else cs.next[cs.last[c - 1]] = j;
+        cs.last[c - 1] = j;
     }
+    cs.permutation = cs.valid == n && count(cs.next.begin(), cs.next.end(), -1) == (long)n;
+    return cs;
+}
+
+static size_t doubleColumnarCipherDirect(string_view message, char *out, const vector<int>& key) {
+    size_t n = key.size();
+    size_t len = message.length();
+    if (n == 0 || len == 0) return 0;
+    const ColumnarSlots& cs = columnarSlots(key);
+    size_t v = cs.valid;
+    size_t rows1 = (len + n - 1) / n, mid = v * rows1;   // first pass: mid bytes
+    size_t rows2 = (mid + n - 1) / n;                     // second pass: v * rows2
+    size_t tile = columnarTileRows(n);
+    const char *msg = message.data();
+
+    size_t fullRows = len / n;
 
-    // Read columns in order of the key
-    string cipher;
-    for (int k : key) {
-        for (int r = 0; r < rows; r++) {
-            if (k - 1 < n && r < grid.size()) {
-                cipher += grid[r][k - 1];
+    // Scatter each tile of message rows (the short last row reads as spaces)
+    for (size_t a0 = 0; a0 < rows1; a0 += tile) {
+        size_t a1 = min(rows1, a0 + tile);
+        size_t fastEnd = cs.permutation ? max(a0, min(a1, fullRows)) : a0;
+        for (size_t b = 0; b < n; b++) {
+            for (int j1 = cs.first[b]; j1 >= 0; j1 = cs.next[j1]) {
+                size_t s = j1 * rows1 + a0;
+                // Permutation key, complete rows: the bytes landing in output
+                // run first[c2] are every n-th one, i.e. message stride n * n.
+                if (fastEnd > a0) {
+                    size_t cnt = fastEnd - a0;
+                    for (size_t c2 = 0; c2 < n; c2++) {
+                        size_t t0 = (c2 + n - s % n) % n;
+                        if (t0 >= cnt) continue;
+                        const char *src = msg + (a0 + t0) * n + b;
+                        char *dst = out + cs.first[c2] * rows2 + (s + t0) / n;
+                        size_t m = (cnt - t0 + n - 1) / n;
+                        for (size_t k = 0; k < m; k++) dst[k] = src[k * n * n];
+                    }
+                }
+                size_t r2 = (s + fastEnd - a0) / n, c2 = (s + fastEnd - a0) % n;
+                for (size_t a = fastEnd; a < a1; a++) {
+                    size_t src = a * n + b;
+                    char ch = src < len ? msg[src] : ' ';
+                    for (int j2 = cs.first[c2]; j2 >= 0; j2 = cs.next[j2]) out[j2 * rows2 + r2] = ch;
+                    if (++c2 == n) { c2 = 0; r2++; }
+                }
             }
         }
     }
-    
-    return cipher;
+    // Second-pass padding: output cells past the end of the intermediate text
+    for (size_t b = 0; b < n; b++) {
+        size_t r2 = mid > b ? (mid - b + n - 1) / n : 0;
+        for (int j2 = cs.first[b]; j2 >= 0; j2 = cs.next[j2])
+            fill(out + j2 * rows2 + r2, out + (j2 + 1) * rows2, ' ');
+    }
+    return v * rows2;
 }
 
-string singleColumnTranspositionDecipher(const string& cipher, const vector<int>& key) {
-    int n = key.size();
-    int len = cipher.length();
-    int rows = (len + n - 1) / n; // Calculate number of rows needed
-    vector<string> grid(rows, string(n, ' '));
-
-    // Fill the grid with cipher text
-    int index = 0;
-    for (int k : key) {
-        for (int r = 0; r < rows; r++) {
-            if (k - 1 < n && index < len) {
-                grid[r][k - 1] = cipher[index++];
+static size_t doubleColumnarDecipherDirect(string_view cipher, char *out, const vector<int>& key) {
+    size_t n = key.size();
+    if (n == 0) return 0;
+    const ColumnarSlots& cs = columnarSlots(key);
+    size_t len = cipher.length();
+    size_t rows = (len + n - 1) / n, tile = columnarTileRows(n);   // both passes use the same grid
+    const char *in = cipher.data();
+
+    // Output cell (r, c) is intermediate byte s = last[c] * rows + r, which is
+    // cell (s / n, s % n) of the first pass. That cell holds cipher byte
+    // j * rows + s / n for the last key position j of column s % n whose run
+    // still reaches that far into the cipher, as in the single decipher.
+    for (size_t r0 = 0; r0 < rows; r0 += tile) {
+        size_t count = min(tile, rows - r0);
+        for (size_t c = 0; c < n; c++) {
+            char *dst = out + r0 * n + c;
+            int j = cs.last[c];
+            if (j < 0) {
+                for (size_t r = 0; r < count; r++) dst[r * n] = ' ';
+                continue;
+            }
+            size_t s = j * rows + r0;
+            if (cs.permutation) {
+                // Rows r with (s + r) % n == c1 read one sequential run of
+                // column c1's ciphertext; they are n rows apart in the output.
+                for (size_t c1 = 0; c1 < n; c1++) {
+                    size_t t0 = (c1 + n - s % n) % n;
+                    if (t0 >= count) continue;
+                    size_t m = (count - t0 + n - 1) / n;
+                    size_t first = cs.first[c1] * rows + (s + t0) / n;
+                    size_t avail = first < len ? min(m, len - first) : 0;
+                    char *d = dst + t0 * n;
+                    for (size_t k = 0; k < avail; k++) d[k * n * n] = in[first + k];
+                    for (size_t k = avail; k < m; k++) d[k * n * n] = ' ';
+                }
+                continue;
+            }
+            size_t r1 = s / n, c1 = s % n;
+            for (size_t r = 0; r < count; r++) {
+                char ch = ' ';
+                for (int j1 = cs.first[c1]; j1 >= 0 && j1 * rows + r1 < len; j1 = cs.next[j1])
+                    ch = in[j1 * rows + r1];
+                dst[r * n] = ch;
+                if (++c1 == n) { c1 = 0; r1++; }
             }
         }
     }
+    return rows * n;
+}
+
+// Plan cache. Fixed-length records under a handful of keys repeat the same
+// permutation over and over, so for messages up to COLUMNAR_PLAN_MAX_LEN the
+// 16-bit source index of every output byte is computed once per (kind, key,
+// length) and kept in a bounded LRU cache; a hit is a single gather. A plan
+// is only built the second time its (kind, key, length) misses, so a stream
+// of one-off messages costs a hash and a short scan, not a plan per message.
+// Longer messages (and a cache with capacity 0) go straight to the engines
+// above.
+enum ColumnarKind { COLUMNAR_SINGLE_ENC, COLUMNAR_SINGLE_DEC, COLUMNAR_DOUBLE_ENC, COLUMNAR_DOUBLE_DEC };
+
+static const size_t COLUMNAR_PLAN_MAX_LEN = UINT16_MAX;
+static const uint16_t COLUMNAR_PAD = UINT16_MAX;   // output byte is a padding space
+
+struct ColumnarPlan {
+    ColumnarKind kind;
+    size_t length;
+    vector<int> key;
+    vector<uint16_t> src;   // out[i] = in[src[i]], or ' ' for COLUMNAR_PAD
+};
 
-    // Read the grid row-wise to get the original message
-    string message;
-    for (const auto& row : grid) {
-        message += row;
+struct ColumnarPlanStats {
+    uint64_t hits = 0, misses = 0, evictions = 0;
+    size_t entries = 0, capacity = 0;
+};
+
+// Index form of the single transpositions, with the same rules for skipped
+// key entries, padding and duplicate columns as the engines.
+static vector<uint16_t> singleColumnarPlan(size_t len, const vector<int>& key, bool decrypt) {
+    size_t n = key.size();
+    vector<uint16_t> src;
+    if (n == 0) return src;
+    size_t rows = (len + n - 1) / n, j = 0;
+    if (decrypt) src.assign(rows * n, COLUMNAR_PAD);
+    for (int c : key) {
+        if (c < 1 || (size_t)c > n) continue;
+        for (size_t r = 0; r < rows; r++) {
+            if (decrypt) {
+                size_t idx = j * rows + r;
+                if (idx < len) src[r * n + c - 1] = idx;
+            } else {
+                size_t idx = r * n + c - 1;
+                src.push_back(idx < len ? idx : COLUMNAR_PAD);
+            }
+        }
+        j++;
     }
-    
-    return message;
+    return src;
 }
 
-string doubleColumnTranspositionCipher(const string& message, const vector<int>& key) {
-    // First transposition: write row-wise, read column-wise
-    int n = key.size();
-    int len = message.length();
-    int rows = (len + n - 1) / n;
-    vector<string> grid(rows, string(n, ' '));
-
-    // Fill the grid row-wise
-    for (int i = 0; i < len; i++) {
-        grid[i / n][i % n] = message[i];
-    }
+static vector<uint16_t> buildColumnarPlan(ColumnarKind kind, size_t len, const vector<int>& key) {
+    bool decrypt = kind == COLUMNAR_SINGLE_DEC || kind == COLUMNAR_DOUBLE_DEC;
+    vector<uint16_t> first = singleColumnarPlan(len, key, decrypt);
+    if (kind == COLUMNAR_SINGLE_ENC || kind == COLUMNAR_SINGLE_DEC) return first;
+    vector<uint16_t> composed = singleColumnarPlan(first.size(), key, decrypt);
+    for (uint16_t &i : composed)
+        if (i != COLUMNAR_PAD) i = first[i];
+    return composed;
+}
+
+class ColumnarPlanCache {
+public:
+    explicit ColumnarPlanCache(size_t capacity) : seen(capacity) { st.capacity = capacity; }
 
-    // Read columns in order of the key (first transposition)
-    string firstCipher;
-    for (int k : key) {
-        for (int r = 0; r < rows; r++) {
-            if (k - 1 < n && r < grid.size()) {
-                firstCipher += grid[r][k - 1];
+    // Cached or freshly built plan; null when the cache is disabled or this
+    // is the first miss for the plan. A hit does not allocate.
+    shared_ptr<const ColumnarPlan> get(ColumnarKind kind, const vector<int>& key, size_t length) {
+        uint64_t h = hashOf(kind, key, length);
+        {
+            lock_guard<mutex> lock(m);
+            if (st.capacity == 0) return nullptr;
+            if (auto hit = find(h, kind, key, length)) {
+                st.hits++;
+                return hit;
             }
+            st.misses++;
+            if (!admit(h)) return nullptr;
         }
+        auto plan = make_shared<ColumnarPlan>();
+        plan->kind = kind;
+        plan->length = length;
+        plan->key = key;
+        plan->src = buildColumnarPlan(kind, length, key);
+
+        lock_guard<mutex> lock(m);
+        if (auto raced = find(h, kind, key, length)) return raced;   // another thread built it
+        lru.push_front(plan);
+        index.emplace(h, lru.begin());
+        trim();
+        return plan;
     }
-    
-    // Second transposition: apply the same process again
-    len = firstCipher.length();
-    rows = (len + n - 1) / n;
-    vector<string> grid2(rows, string(n, ' '));
-
-    // Fill the grid row-wise with first cipher
-    for (int i = 0; i < len; i++) {
-        grid2[i / n][i % n] = firstCipher[i];
+
+    void setCapacity(size_t capacity) {
+        lock_guard<mutex> lock(m);
+        st.capacity = capacity;
+        seen.assign(capacity, 0);
+        next = 0;
+        trim();
+    }
+
+    ColumnarPlanStats stats() {
+        lock_guard<mutex> lock(m);
+        ColumnarPlanStats s = st;
+        s.entries = lru.size();
+        return s;
     }
 
-    // Read columns in order of the key (second transposition)
-    string finalCipher;
-    for (int k : key) {
-        for (int r = 0; r < rows; r++) {
-            if (k - 1 < n && r < grid2.size()) {
-                finalCipher += grid2[r][k - 1];
+private:
+    using Entry = list<shared_ptr<const ColumnarPlan>>::iterator;
+    mutex m;
+    list<shared_ptr<const ColumnarPlan>> lru;   // most recently used first
+    unordered_multimap<uint64_t, Entry> index;
+    ColumnarPlanStats st;
+    vector<uint64_t> seen;   // hashes of recent first misses, a ring of `capacity`
+    size_t next = 0;
+
+    // Second-miss admission: true if h already missed recently, otherwise
+    // remembers it (displacing the oldest) and returns false.
+    bool admit(uint64_t h) {
+        for (uint64_t &s : seen)
+            if (s == h) { s = 0; return true; }
+        seen[next] = h;
+        next = (next + 1) % seen.size();
+        return false;
+    }
+
+    static uint64_t hashOf(ColumnarKind kind, const vector<int>& key, size_t length) {
+        uint64_t h = 1469598103934665603ull;   // FNV-1a
+        auto mix = [&](uint64_t v) { h = (h ^ v) * 1099511628211ull; };
+        mix(kind);
+        mix(length);
+        for (int k : key) mix((uint32_t)k);
+        return h;
+    }
+
+    shared_ptr<const ColumnarPlan> find(uint64_t h, ColumnarKind kind, const vector<int>& key, size_t length) {
+        auto range = index.equal_range(h);
+        for (auto it = range.first; it != range.second; ++it) {
+            const ColumnarPlan& p = **it->second;
+            if (p.kind == kind && p.length == length && p.key == key) {
+                lru.splice(lru.begin(), lru, it->second);
+                return *it->second;
             }
         }
+        return nullptr;
     }
-    
-    return finalCipher;
+
+    void trim() {
+        while (lru.size() > st.capacity) {
+            const ColumnarPlan& p = *lru.back();
+            auto range = index.equal_range(hashOf(p.kind, p.key, p.length));
+            for (auto it = range.first; it != range.second; ++it)
+                if (it->second == prev(lru.end())) { index.erase(it); break; }
+            lru.pop_back();
+            st.evictions++;
+        }
+    }
+};
+
+static ColumnarPlanCache& columnarPlanCache() {
+    static ColumnarPlanCache cache(64);
+    return cache;
+}
+
+// Hit/miss counters, for sizing the cache (default 64 plans).
+ColumnarPlanStats columnarPlanCacheStats() {
+    return columnarPlanCache().stats();
+}
+
+// 0 disables the cache and drops every plan.
+void setColumnarPlanCacheCapacity(size_t plans) {
+    columnarPlanCache().setCapacity(plans);
+}
+
+static size_t columnarTransform(ColumnarKind kind, string_view in, char *out, const vector<int>& key) {
+    // Intermediate and output indices must stay below COLUMNAR_PAD too
+    if (columnarOutputLength(in.size(), key.size()) < COLUMNAR_PLAN_MAX_LEN) {
+        if (auto plan = columnarPlanCache().get(kind, key, in.size())) {
+            const uint16_t *src = plan->src.data();
+            size_t len = plan->src.size();
+            for (size_t i = 0; i < len; i++) out[i] = src[i] != COLUMNAR_PAD ? in[src[i]] : ' ';
+            return len;
+        }
+    }
+    switch (kind) {
+        case COLUMNAR_SINGLE_ENC: return singleColumnarCipherDirect(in, out, key);
+        case COLUMNAR_SINGLE_DEC: return singleColumnarDecipherDirect(in, out, key);
+        case COLUMNAR_DOUBLE_ENC: return doubleColumnarCipherDirect(in, out, key);
+        default: return doubleColumnarDecipherDirect(in, out, key);
+    }
+}
+
+size_t singleColumnTranspositionCipher(string_view message, char *out, const vector<int>& key) {
+    return columnarTransform(COLUMNAR_SINGLE_ENC, message, out, key);
+}
+
+size_t singleColumnTranspositionDecipher(string_view cipher, char *out, const vector<int>& key) {
+    return columnarTransform(COLUMNAR_SINGLE_DEC, cipher, out, key);
+}
+
+size_t doubleColumnTranspositionCipher(string_view message, char *out, const vector<int>& key) {
+    return columnarTransform(COLUMNAR_DOUBLE_ENC, message, out, key);
+}
+
+size_t doubleColumnTranspositionDecipher(string_view cipher, char *out, const vector<int>& key) {
+    return columnarTransform(COLUMNAR_DOUBLE_DEC, cipher, out, key);
+}
+
+string railFenceCipher(string message, int rails = 2, size_t offset = 0){
+    string cipher_text(message.length(), '\0');
+    railFenceCipher(string_view(message), &cipher_text[0], rails, offset);
+    return cipher_text;
+}
+
+string railFenceDecipher(string cipher_text, int rails = 2, size_t offset = 0){
+    string message(cipher_text.length(), '\0');
+    railFenceDecipher(string_view(cipher_text), &message[0], rails, offset);
+    return message;
+}
+
+string singleColumnTranspositionCipher(const string& message, const vector<int>& key) {
+    string cipher(columnarOutputLength(message.length(), key.size()), '\0');
+    cipher.resize(singleColumnTranspositionCipher(string_view(message), &cipher[0], key));
+    return cipher;
+}
+
+string singleColumnTranspositionDecipher(const string& cipher, const vector<int>& key) {
+    string message(columnarOutputLength(cipher.length(), key.size()), '\0');
+    message.resize(singleColumnTranspositionDecipher(string_view(cipher), &message[0], key));
+    return message;
+}
+
+string doubleColumnTranspositionCipher(const string& message, const vector<int>& key) {
+    string cipher(columnarOutputLength(message.length(), key.size()), '\0');
+    cipher.resize(doubleColumnTranspositionCipher(string_view(message), &cipher[0], key));
+    return cipher;
 }
 
 string doubleColumnTranspositionDecipher(const string& cipher, const vector<int>& key) {
-    // Create inverse key for decryption
-    vector<int> inverseKey(key.size());
-    for (int i = 0; i < key.size(); i++) {
-        inverseKey[key[i] - 1] = i + 1;
+    string message(columnarOutputLength(cipher.length(), key.size()), '\0');
+    message.resize(doubleColumnTranspositionDecipher(string_view(cipher), &message[0], key));
+    return message;
+}
+
+// Columnar cryptanalysis: recover a permutation key of known width by
+// decrypting with each candidate and scoring the letters with English
+// quadgrams (bigrams for very short texts). Width <= COLUMNAR_EXHAUSTIVE_MAX
+// tries every permutation, split into tasks by the first two key entries;
+// wider keys use hill-climbing restarts (swap two entries or move a block).
+// Tasks sit in per-worker deques: a worker pops its own from the front and
+// steals from the back of the others once it runs dry. Each worker decrypts
+// into its own buffers, so scoring a candidate allocates nothing.
+struct ColumnarCrackResult {
+    vector<int> key;
+    string plaintext;
+    double score = -1e300;
+    uint64_t keysTried = 0;
+    double seconds = 0;
+    vector<double> keysPerSecond;   // per worker thread
+};
+
+static const int COLUMNAR_EXHAUSTIVE_MAX = 9;
+
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(unsigned workers) : queues(workers), locks(workers) {}
+
+    void push(unsigned worker, unsigned task) {
+        lock_guard<mutex> guard(locks[worker]);
+        queues[worker].push_back(task);
     }
-    
-    // First decryption (reverse of second encryption)
-    int n = key.size();
-    int len = cipher.length();
-    int rows = (len + n - 1) / n;
-    vector<string> grid(rows, string(n, ' '));
-
-    // Fill the grid with cipher text using inverse key
-    int index = 0;
-    for (int k : key) {
-        for (int r = 0; r < rows; r++) {
-            if (k - 1 < n && index < len) {
-                grid[r][k - 1] = cipher[index++];
-            }
+
+    bool pop(unsigned worker, unsigned &task) {
+        for (unsigned k = 0; k < queues.size(); k++) {
+            unsigned victim = (worker + k) % queues.size();
+            lock_guard<mutex> guard(locks[victim]);
+            deque<unsigned> &q = queues[victim];
+            if (q.empty()) continue;
+            if (k == 0) { task = q.front(); q.pop_front(); }
+            else { task = q.back(); q.pop_back(); }
+            return true;
         }
+        return false;
     }
 
-    // Read the grid row-wise to get first decryption
-    string firstDecrypt;
-    for (const auto& row : grid) {
-        firstDecrypt += row;
+private:
+    vector<deque<unsigned>> queues;
+    vector<mutex> locks;
+};
+
+// Decrypts `cipher` under `key` into `buf` and scores its letters.
+static double scoreColumnarKey(string_view cipher, const vector<int>& key, bool isDouble,
+                               string &buf, vector<uint8_t> &letters, const NgramScorer &scorer) {
+    size_t len = isDouble ? doubleColumnarDecipherDirect(cipher, &buf[0], key)
+                          : singleColumnarDecipherDirect(cipher, &buf[0], key);
+    size_t m = 0;
+    for (size_t i = 0; i < len; i++) {
+        unsigned idx = (unsigned)((buf[i] | 0x20) - 'a');
+        if (idx < 26) letters[m++] = idx;
     }
-    
-    // Second decryption (reverse of first encryption)
-    len = firstDecrypt.length();
-    rows = (len + n - 1) / n;
-    vector<string> grid2(rows, string(n, ' '));
-
-    // Fill the grid with first decryption using inverse key
-    index = 0;
-    for (int k : key) {
-        for (int r = 0; r < rows; r++) {
-            if (k - 1 < n && index < len) {
-                grid2[r][k - 1] = firstDecrypt[index++];
+    return m >= 8 ? scorer.score(letters.data(), m) : scorer.bigramScore(letters.data(), m);
+}
+
+// `restarts` only applies to hill-climbing (width > COLUMNAR_EXHAUSTIVE_MAX).
+ColumnarCrackResult crackColumnar(const string &cipher, int width, bool isDouble = false,
+                                  unsigned threads = 0, unsigned restarts = 64, bool verbose = true) {
+    ColumnarCrackResult best;
+    if (width < 1 || cipher.empty()) return best;
+    if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+
+    const NgramScorer &scorer = NgramScorer::english();
+    bool exhaustive = width <= COLUMNAR_EXHAUSTIVE_MAX;
+    unsigned tasks = exhaustive ? (width == 1 ? 1 : width * (width - 1)) : restarts;
+    threads = min(threads, max(1u, tasks));
+    WorkStealingQueues queues(threads);
+    for (unsigned t = 0; t < tasks; t++) queues.push(t % threads, t);
+
+    atomic<uint64_t> tried(0);
+    mutex bestLock;
+    best.keysPerSecond.assign(threads, 0);
+    auto t0 = chrono::steady_clock::now();
+
+    auto worker = [&](unsigned self) {
+        string buf(columnarOutputLength(cipher.size(), width), ' ');
+        vector<uint8_t> letters(buf.size());
+        vector<int> key(width), localKey(width), saved(width);
+        double localBest = -1e300;
+        uint64_t count = 0;
+        auto started = chrono::steady_clock::now();
+        auto score = [&](const vector<int>& k) {
+            count++;
+            return scoreColumnarKey(cipher, k, isDouble, buf, letters, scorer);
+        };
+        auto offer = [&](const vector<int>& k, double s) {
+            if (s > localBest) { localBest = s; localKey = k; }
+        };
+
+        for (unsigned task; queues.pop(self, task); ) {
+            if (exhaustive) {
+                // Key entries 0 and 1 are fixed by the task; permute the rest
+                int a = width == 1 ? 0 : task / (width - 1), b = width == 1 ? 0 : task % (width - 1);
+                if (width > 1 && b >= a) b++;
+                key.clear();
+                key.push_back(a + 1);
+                if (width > 1) key.push_back(b + 1);
+                for (int c = 0; c < width; c++)
+                    if (c != a && (width == 1 || c != b)) key.push_back(c + 1);
+                auto rest = key.begin() + min(width, 2);
+                do offer(key, score(key)); while (next_permutation(rest, key.end()));
+            } else {
+                mt19937 rng(0x9E3779B9u * (task + 1));
+                for (int i = 0; i < width; i++) key[i] = i + 1;
+                shuffle(key.begin(), key.end(), rng);
+                double current = score(key);
+                for (bool improved = true; improved; ) {
+                    improved = false;
+                    for (int i = 0; i < width && !improved; i++)
+                        for (int j = i + 1; j < width && !improved; j++) {
+                            swap(key[i], key[j]);
+                            double s = score(key);
+                            if (s > current) { current = s; improved = true; }
+                            else swap(key[i], key[j]);
+                        }
+                    // Move a block of 1..3 entries to another position
+                    for (int len = 1; len <= 3 && !improved; len++)
+                        for (int from = 0; from + len <= width && !improved; from++)
+                            for (int to = 0; to + len <= width && !improved; to++) {
+                                if (to == from) continue;
+                                saved = key;
+                                auto k = key.begin();
+                                if (to > from) rotate(k + from, k + from + len, k + to + len);
+                                else rotate(k + to, k + from, k + from + len);
+                                double s = score(key);
+                                if (s > current) { current = s; improved = true; }
+                                else key = saved;
+                            }
+                }
+                offer(key, current);
             }
         }
-    }
 
-    // Read the grid row-wise to get original message
-    string message;
-    for (const auto& row : grid2) {
-        message += row;
+        double secs = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+        tried += count;
+        lock_guard<mutex> guard(bestLock);
+        best.keysPerSecond[self] = count / max(secs, 1e-9);
+        if (localBest > best.score) {
+            best.score = localBest;
+            best.key = localKey;
+        }
+    };
+
+    vector<thread> pool;
+    for (unsigned i = 0; i < threads; i++) pool.emplace_back(worker, i);
+    for (auto &t : pool) t.join();
+
+    best.keysTried = tried;
+    best.seconds = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    best.plaintext = isDouble ? doubleColumnTranspositionDecipher(cipher, best.key)
+                              : singleColumnTranspositionDecipher(cipher, best.key);
+    if (verbose) {
+        cout << "Tried " << best.keysTried << " keys in " << best.seconds << " s ("
+             << (uint64_t)(best.keysTried / max(best.seconds, 1e-9)) << " keys/s)\n";
+        for (unsigned i = 0; i < threads; i++)
+            cout << "  thread " << i << ": " << (uint64_t)best.keysPerSecond[i] << " keys/s\n";
     }
-    
-    return message;
+    return best;
 }
+
+// Define CNS_NO_MAIN to reuse the functions above from another program
+// (see Benchmark.cpp).
+#ifndef CNS_NO_MAIN
 int main(){
     int choice;
     string message, encrypted, decrypted;
@@ -239,9 +704,10 @@ int main(){
         cout << "1. Rail Fence Cipher\n";
         cout << "2. Single Column Transposition Cipher\n";
         cout << "3. Double Column Transposition Cipher\n";
-        cout << "4. Exit\n";
+        cout << "4. Columnar Key Search\n";
+        cout << "5. Exit\n";
         cout << "==========================================\n";
-        cout << "Enter your choice (1-4): ";
+        cout << "Enter your choice (1-5): ";
         cin >> choice;
         cin.ignore(); // Clear the input buffer
         
@@ -251,10 +717,18 @@ int main(){
                 cout << "Enter the message: ";
                 getline(cin, message);
                 
-                encrypted = railFenceCipher(message);
+                int rails;
+                size_t offset;
+                cout << "Enter the number of rails: ";
+                cin >> rails;
+                cout << "Enter the starting offset (0 for none): ";
+                cin >> offset;
+                cin.ignore();
+                
+                encrypted = railFenceCipher(message, rails, offset);
                 cout << "Encrypted: " << encrypted << endl;
                 
-                decrypted = railFenceDecipher(encrypted);
+                decrypted = railFenceDecipher(encrypted, rails, offset);
                 cout << "Decrypted: " << decrypted << endl;
                 break;
             }
@@ -313,21 +787,44 @@ int main(){
                 break;
             }
             
-            case 4:
+            case 4: {
+                cout << "\n--- Columnar Key Search ---\n";
+                cout << "Enter the ciphertext: ";
+                getline(cin, message);
+                
+                int width, passes;
+                unsigned threads;
+                cout << "Enter the key width: ";
+                cin >> width;
+                cout << "Single (1) or double (2) transposition: ";
+                cin >> passes;
+                cout << "Worker threads (0 = all cores): ";
+                cin >> threads;
+                cin.ignore();
+                
+                ColumnarCrackResult res = crackColumnar(message, width, passes == 2, threads);
+                cout << "Recovered key:";
+                for (int k : res.key) cout << " " << k;
+                cout << "\nPlaintext: " << res.plaintext << endl;
+                break;
+            }
+            
+            case 5:
                 cout << "\nExiting program. Goodbye!\n";
                 break;
                 
             default:
-                cout << "\nInvalid choice! Please enter a number between 1-4.\n";
+                cout << "\nInvalid choice! Please enter a number between 1-5.\n";
                 break;
         }
         
-        if(choice != 4) {
+        if(choice != 5) {
             cout << "\nPress Enter to continue...";
             cin.get();
         }
         
-    } while(choice != 4);
+    } while(choice != 5);
     
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -3,6 +3,18 @@
 #include <string>
 #include <sstream>
 #include <limits>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include "BigUInt.h"
 
 using namespace std;
 
@@ -37,23 +49,86 @@ long long modInverse(long long e, long long phi){
     return x;
 }
 
+// Products are taken in 128 bits so any n below 2^63 works.
 long long modPow(long long base, long long exp, long long mod){
     long long res = 1 % mod;
     base %= mod;
     while(exp > 0){
-        if(exp & 1) res = (res * base) % mod;
-        base = (base * base) % mod;
+        if(exp & 1) res = (long long)((__int128)res * base % mod);
+        base = (long long)((__int128)base * base % mod);
         exp >>= 1;
     }
     return res;
 }
 
-// Simple primality test (sufficient for classroom-sized inputs)
+/* ---------- Multi-precision versions (see BigUInt.h) ----------
+   Same contracts as the long long functions, except that modInverse returns
+   0 (never a valid inverse) when gcd(e, phi) != 1. Use a width of at least
+   the modulus size, e.g. UInt2048 for a 2048-bit key.
+*/
+template<size_t L>
+BigUInt<L> gcd(BigUInt<L> a, BigUInt<L> b){
+    while(!b.isZero()){
+        BigUInt<L> t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Extended Euclid on magnitudes: the Bezout coefficients of phi alternate in
+// sign, so |t(i+1)| = |t(i-1)| + q * |t(i)| and the sign follows the step count.
+template<size_t L>
+BigUInt<L> modInverse(const BigUInt<L>& e, const BigUInt<L>& phi){
+    if(phi <= BigUInt<L>(1)) return BigUInt<L>();
+    BigUInt<L> r0 = phi, r1 = e % phi, t0, t1(1), q, r;
+    bool oddSteps = false;
+    while(!r1.isZero()){
+        BigUInt<L>::divMod(r0, r1, q, r);
+        BigUInt<L> t = t0 + q * t1;
+        r0 = r1; r1 = r;
+        t0 = t1; t1 = t;
+        oddSteps = !oddSteps;
+    }
+    if(r0 != BigUInt<L>(1)) return BigUInt<L>();
+    // t0 is the coefficient after k steps, positive exactly when k is odd.
+    return oddSteps ? t0 : phi - t0;
+}
+
+template<size_t L>
+BigUInt<L> modPow(const BigUInt<L>& base, const BigUInt<L>& exp, const BigUInt<L>& mod){
+    if(mod.isOdd() && mod != BigUInt<L>(1)) return Montgomery<L>(mod).pow(base, exp);
+    // Even modulus: square-and-multiply with full products and division.
+    BigUInt<2 * L> wideMod = mod.template resize<2 * L>();
+    BigUInt<L> res = (BigUInt<2 * L>(1) % wideMod).template resize<L>();
+    BigUInt<L> b = base % mod;
+    for(size_t i = exp.bitLength(); i-- > 0;){
+        res = (mulWide(res, res) % wideMod).template resize<L>();
+        if(exp.bit(i)) res = (mulWide(res, b) % wideMod).template resize<L>();
+    }
+    return res;
+}
+
+// Deterministic Miller-Rabin: the first twelve primes as bases are exact for
+// every n below 3.3e24, which covers all of long long.
 bool isPrime(long long n){
+    static const long long bases[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
     if(n < 2) return false;
-    if(n % 2 == 0) return n == 2;
-    for(long long i = 3; i * i <= n; i += 2)
-        if(n % i == 0) return false;
+    for(long long b : bases)
+        if(n % b == 0) return n == b;
+    long long d = n - 1;
+    int s = 0;
+    while(d % 2 == 0){ d /= 2; ++s; }
+    for(long long a : bases){
+        long long x = modPow(a, d, n);
+        if(x == 1 || x == n - 1) continue;
+        int r = 1;
+        for(; r < s; ++r){
+            x = (long long)((__int128)x * x % n);
+            if(x == n - 1) break;
+        }
+        if(r == s) return false;
+    }
     return true;
 }
 
@@ -68,6 +143,11 @@ struct EncodeMode {
     bool digitMode = false;
     int base = 0;
     int digitsPerByte = 0;
+    // Packed mode (rsaEncryptPacked): bytesPerBlock message bytes per block,
+    // big-endian, the last block zero-padded to messageLength.
+    bool packed = false;
+    size_t bytesPerBlock = 0;
+    size_t messageLength = 0;
 };
 
 static int calcDigitsPerByte(int base){
@@ -79,23 +159,34 @@ static int calcDigitsPerByte(int base){
     return d;
 }
 
-static vector<long long> rsaEncryptMessage(const string& msg, long long e, long long n, EncodeMode &mode){
-    vector<long long> out;
-    if(n > 255){
+static long long lowWord(long long v){ return v; }
+template<size_t L>
+static uint64_t lowWord(const BigUInt<L>& v){ return v.low(); }
+static size_t bitLengthOf(long long v){ return v > 0 ? 64 - __builtin_clzll(v) : 0; }
+template<size_t L>
+static size_t bitLengthOf(const BigUInt<L>& v){ return v.bitLength(); }
+
+// Encoding shared by the long long and BigUInt versions; `crypt` maps one
+// block value to its RSA image (modPow with e, or with d when decrypting).
+template<class Int, class Crypt>
+static vector<Int> rsaEncryptBlocks(const string& msg, const Int& n, EncodeMode &mode, Crypt crypt){
+    vector<Int> out;
+    mode.packed = false;
+    if(n > Int(255)){
         // Simple mode: each byte < n
         mode.digitMode = false;
         for(unsigned char c : msg){
-            if(c >= n){
+            if(Int(c) >= n){
                 // Should not happen because we checked n > 255
                 throw runtime_error("Byte >= n in simple mode.");
             }
-            out.push_back(modPow(c, e, n));
+            out.push_back(crypt(Int(c)));
         }
         return out;
     }
     // Digit mode
     mode.digitMode = true;
-    mode.base = static_cast<int>(n - 1);       // digits range: 0 .. base-1
+    mode.base = static_cast<int>(lowWord(n)) - 1;       // digits range: 0 .. base-1
     if(mode.base < 2) throw runtime_error("Modulus too small (n-1 < 2).");
     mode.digitsPerByte = calcDigitsPerByte(mode.base);
     for(unsigned char c : msg){
@@ -108,19 +199,63 @@ static vector<long long> rsaEncryptMessage(const string& msg, long long e, long
         }
         // Encrypt each digit
         for(int d : digits){
-            out.push_back(modPow(d, e, n));
+            out.push_back(crypt(Int(d)));
         }
     }
     return out;
 }
 
-static string rsaDecryptMessage(const vector<long long>& cipher, long long d, long long n, const EncodeMode &mode){
+/* Packed mode: instead of one block per byte, each block carries
+   k = (bits(n) - 1) / 8 message bytes as a big-endian number, which is always
+   below n. A 2048-bit key packs 255 bytes per exponentiation.
+*/
+template<class Int, class Crypt>
+static vector<Int> rsaEncryptPackedBlocks(const string& msg, const Int& n, EncodeMode &mode, Crypt crypt){
+    size_t k = (bitLengthOf(n) - 1) / 8;
+    if(k == 0) throw runtime_error("Modulus too small for packing (need n > 255).");
+    mode = EncodeMode();
+    mode.packed = true;
+    mode.bytesPerBlock = k;
+    mode.messageLength = msg.size();
+    vector<Int> out;
+    out.reserve((msg.size() + k - 1) / k);
+    for(size_t i = 0; i < msg.size(); i += k){
+        Int block(0);
+        for(size_t j = i; j < i + k; ++j)
+            block = (block << 8) + Int(j < msg.size() ? (unsigned char)msg[j] : 0);
+        out.push_back(crypt(block));
+    }
+    return out;
+}
+
+template<class Int, class Crypt>
+static string rsaDecryptPackedBlocks(const vector<Int>& cipher, const EncodeMode &mode, Crypt crypt){
+    size_t k = mode.bytesPerBlock;
+    if(k == 0) throw runtime_error("Invalid bytesPerBlock.");
+    if(cipher.size() != (mode.messageLength + k - 1) / k)
+        throw runtime_error("Cipher length does not match the message length.");
+    string recovered(cipher.size() * k, '\0');
+    for(size_t i = 0; i < cipher.size(); ++i){
+        Int m = crypt(cipher[i]);
+        if(m < Int(0) || bitLengthOf(m) > 8 * k) throw runtime_error("Decrypted block out of range.");
+        for(size_t j = k; j-- > 0;){
+            recovered[i * k + j] = static_cast<char>(lowWord(m) & 0xFF);
+            m = m >> 8;
+        }
+    }
+    recovered.resize(mode.messageLength);
+    return recovered;
+}
+
+template<class Int, class Crypt>
+static string rsaDecryptBlocks(const vector<Int>& cipher, const EncodeMode &mode, Crypt crypt){
+    if(mode.packed) return rsaDecryptPackedBlocks(cipher, mode, crypt);
     string recovered;
     if(!mode.digitMode){
-        for(long long c : cipher){
-            long long m = modPow(c, d, n);
-            if(m < 0 || m > 255) throw runtime_error("Decrypted value out of byte range.");
-            recovered.push_back(static_cast<char>(m));
+        for(const Int& c : cipher){
+            Int m = crypt(c);
+            if(m < Int(0) || m > Int(255)) throw runtime_error("Decrypted value out of byte range.");
+            recovered.push_back(static_cast<char>(lowWord(m)));
         }
         return recovered;
     }
@@ -133,9 +268,9 @@ static string rsaDecryptMessage(const vector<long long>& cipher, long long d, lo
         int value = 0;
         int mul = 1;
         for(int j = 0; j < L; ++j){
-            long long digit = modPow(cipher[i + j], d, n);
-            if(digit < 0 || digit >= B) throw runtime_error("Digit out of range after decryption.");
-            value += static_cast<int>(digit) * mul;
+            Int digit = crypt(cipher[i + j]);
+            if(digit < Int(0) || digit >= Int(B)) throw runtime_error("Digit out of range after decryption.");
+            value += static_cast<int>(lowWord(digit)) * mul;
             mul *= B;
         }
         if(value > 255) throw runtime_error("Reconstructed byte out of range.");
@@ -144,7 +279,522 @@ static string rsaDecryptMessage(const vector<long long>& cipher, long long d, lo
     return recovered;
 }
 
+/* ---------- Lookup tables for byte and digit mode ----------
+   Byte mode only ever encrypts the 256 values 0..255 and digit mode the
+   values 0..n-2, so each public key gets a table of their images, filled the
+   first time a value is seen; after that a block is an array lookup. The
+   private side keeps a hash table from ciphertext to plaintext per key,
+   so a message costs at most one exponentiation per distinct byte (digit).
+   The tables live in per-thread storage for the most recently used key.
+   Packed mode does not repeat block values and bypasses them.
+*/
+static const size_t RSA_MEMO_LIMIT = 4096;   // caps the table for foreign or corrupt ciphertexts
+
+struct RsaIntHash {
+    size_t operator()(long long v) const { return hash<long long>()(v); }
+    template<size_t L>
+    size_t operator()(const BigUInt<L>& v) const {
+        uint64_t h = 1469598103934665603ull;   // FNV-1a over the limbs
+        for(uint64_t w : v.limb) h = (h ^ w) * 1099511628211ull;
+        return static_cast<size_t>(h);
+    }
+};
+
+template<class Int>
+class RsaEncryptTable {
+public:
+    void reset(size_t count){
+        images.assign(count, Int());
+        known.assign(count, false);
+    }
+    // m^e mod n for m < count; `crypt` computes it on a miss.
+    template<class Crypt>
+    Int operator()(const Int& m, Crypt crypt){
+        size_t v = static_cast<size_t>(lowWord(m));
+        if(!known[v]){
+            images[v] = crypt(m);
+            known[v] = true;
+        }
+        return images[v];
+    }
+
+private:
+    vector<Int> images;
+    vector<bool> known;
+};
+
+template<class Int>
+class RsaDecryptTable {
+public:
+    void clear(){ plain.clear(); }
+    template<class Crypt>
+    Int operator()(const Int& c, Crypt crypt){
+        auto it = plain.find(c);
+        if(it != plain.end()) return it->second;
+        Int m = crypt(c);
+        if(plain.size() < RSA_MEMO_LIMIT) plain.emplace(c, m);
+        return m;
+    }
+
+private:
+    unordered_map<Int, Int, RsaIntHash> plain;
+};
+
+// `id` identifies the key (e.g. {e, n}); the per-thread table is reset when
+// it changes.
+template<class Int, class Id, class Crypt>
+static vector<Int> rsaEncryptWithTable(const string& msg, const Int& n, EncodeMode &mode, const Id& id, Crypt crypt){
+    static thread_local RsaEncryptTable<Int> table;
+    static thread_local Id tableId{};
+    if(!(tableId == id)){
+        table.reset(n > Int(255) ? 256 : n > Int(0) ? static_cast<size_t>(lowWord(n)) : 0);
+        tableId = id;
+    }
+    return rsaEncryptBlocks(msg, n, mode, [&](const Int& m){ return table(m, crypt); });
+}
+
+template<class Int, class Id, class Crypt>
+static string rsaDecryptWithTable(const vector<Int>& cipher, const EncodeMode &mode, const Id& id, Crypt crypt){
+    if(mode.packed) return rsaDecryptBlocks(cipher, mode, crypt);
+    static thread_local RsaDecryptTable<Int> table;
+    static thread_local Id tableId{};
+    if(!(tableId == id)){
+        table.clear();
+        tableId = id;
+    }
+    return rsaDecryptBlocks(cipher, mode, [&](const Int& c){ return table(c, crypt); });
+}
+
+vector<long long> rsaEncryptMessage(const string& msg, long long e, long long n, EncodeMode &mode){
+    return rsaEncryptWithTable(msg, n, mode, array<long long, 2>{e, n}, [&](long long m){ return modPow(m, e, n); });
+}
+
+string rsaDecryptMessage(const vector<long long>& cipher, long long d, long long n, const EncodeMode &mode){
+    return rsaDecryptWithTable(cipher, mode, array<long long, 2>{d, n}, [&](long long c){ return modPow(c, d, n); });
+}
+
+vector<long long> rsaEncryptPacked(const string& msg, long long e, long long n, EncodeMode &mode){
+    return rsaEncryptPackedBlocks(msg, n, mode, [&](long long m){ return modPow(m, e, n); });
+}
+
+// Multi-precision keys: one Montgomery context per message. n must be odd.
+template<size_t L>
+static vector<BigUInt<L>> rsaEncryptMessage(const string& msg, const BigUInt<L>& e, const BigUInt<L>& n, EncodeMode &mode){
+    Montgomery<L> mont(n);
+    return rsaEncryptWithTable(msg, n, mode, array<BigUInt<L>, 2>{e, n}, [&](const BigUInt<L>& m){ return mont.pow(m, e); });
+}
+
+template<size_t L>
+static vector<BigUInt<L>> rsaEncryptPacked(const string& msg, const BigUInt<L>& e, const BigUInt<L>& n, EncodeMode &mode){
+    Montgomery<L> mont(n);
+    return rsaEncryptPackedBlocks(msg, n, mode, [&](const BigUInt<L>& m){ return mont.pow(m, e); });
+}
+
+template<size_t L>
+static string rsaDecryptMessage(const vector<BigUInt<L>>& cipher, const BigUInt<L>& d, const BigUInt<L>& n, const EncodeMode &mode){
+    Montgomery<L> mont(n);
+    return rsaDecryptWithTable(cipher, mode, array<BigUInt<L>, 2>{d, n}, [&](const BigUInt<L>& c){ return mont.pow(c, d); });
+}
+
+/* ---------- CRT decryption ----------
+   With p and q known, c^d mod n is computed as two half-size exponentiations
+   m1 = c^dp mod p, m2 = c^dq mod q (dp = d mod (p-1), dq = d mod (q-1)) and
+   recombined with Garner's formula m = m2 + q * (qInv * (m1 - m2) mod p),
+   qInv = q^-1 mod p. Half the exponent bits at half the width: ~3-4x faster.
+*/
+struct CrtKey {
+    long long p = 0, q = 0, dp = 0, dq = 0, qInv = 0;
+};
+
+CrtKey makeCrtKey(long long p, long long q, long long d){
+    CrtKey k;
+    k.p = p; k.q = q;
+    // Reduced into 1..p-1 rather than 0..p-2 so p = 2 still works (a zero
+    // exponent would map c = 0 to 1).
+    k.dp = (d - 1) % (p - 1) + 1;
+    k.dq = (d - 1) % (q - 1) + 1;
+    k.qInv = modInverse(q % p, p);
+    if(k.qInv == -1) throw runtime_error("p and q must be distinct primes.");
+    return k;
+}
+
+static long long crtPow(long long c, const CrtKey &k){
+    long long m1 = modPow(c, k.dp, k.p);
+    long long m2 = modPow(c, k.dq, k.q);
+    long long h = (long long)((__int128)k.qInv * ((m1 - m2 % k.p + k.p) % k.p) % k.p);
+    return m2 + h * k.q;
+}
+
+string rsaDecryptMessage(const vector<long long>& cipher, const CrtKey &key, const EncodeMode &mode){
+    array<long long, 4> id{key.p, key.q, key.dp, key.dq};
+    return rsaDecryptWithTable(cipher, mode, id, [&](long long c){ return crtPow(c, key); });
+}
+
+// Multi-precision private key for an L-limb modulus. p and q must each fit
+// in L/2 limbs (they do for keys from two equal-size primes); the Montgomery
+// contexts for p and q are built once here.
+template<size_t L>
+class RsaPrivateKey {
+public:
+    static_assert(L % 2 == 0, "RsaPrivateKey needs an even limb count");
+    using Int = BigUInt<L>;
+    using Half = BigUInt<L / 2>;
+
+    Int n, d;
+    Half p, q, dp, dq, qInv;
+
+    // Throws runtime_error unless p != q are odd and e is invertible mod phi.
+    RsaPrivateKey(const Half &p_, const Half &q_, const Int &e)
+        : p(p_), q(q_), mp(checkedModulus(p_)), mq(checkedModulus(q_)) {
+        if(p == q) throw runtime_error("q must differ from p.");
+        Int p1 = p.template resize<L>() - Int(1), q1 = q.template resize<L>() - Int(1);
+        n = mulWide(p, q);
+        d = modInverse(e, mulWide(p - Half(1), q - Half(1)));
+        if(d.isZero()) throw runtime_error("e is not invertible mod phi.");
+        dp = (d % p1).template resize<L / 2>();
+        dq = (d % q1).template resize<L / 2>();
+        qInv = modInverse(q, p);
+        if(qInv.isZero()) throw runtime_error("p and q must be coprime.");
+        qInvMont = mp.toMont(qInv);
+    }
+
+    // c^d mod n via CRT.
+    Int pow(const Int &c) const {
+        Half m1 = mp.pow(mp.reduce(c), dp);
+        Half m2 = mq.pow(mq.reduce(c), dq);
+        Half m2p = mp.reduce(m2.template resize<L>());
+        Half diff = m1;
+        if(diff.sub(m2p)) diff.add(p);
+        Half h = mp.mul(diff, qInvMont);          // (m1 - m2) * qInv mod p
+        Int m = mulWide(h, q);
+        m.add(m2.template resize<L>());
+        return m;
+    }
+
+private:
+    static const Half &checkedModulus(const Half &v){
+        if(!v.isOdd() || v == Half(1)) throw runtime_error("p and q must be odd primes.");
+        return v;
+    }
+    Montgomery<L / 2> mp, mq;
+    Half qInvMont;
+};
+
+template<size_t L>
+static string rsaDecryptMessage(const vector<BigUInt<L>>& cipher, const RsaPrivateKey<L> &key, const EncodeMode &mode){
+    return rsaDecryptWithTable(cipher, mode, array<BigUInt<L>, 2>{key.d, key.n}, [&](const BigUInt<L>& c){ return key.pow(c); });
+}
+
+/* ---------- Parallel bulk RSA ----------
+   Every block is an independent exponentiation, so bulk jobs go to a fixed
+   pool of worker threads that stay alive between calls. Workers claim
+   RSA_BULK_CHUNK blocks at a time from a shared counter (blocks cost the same,
+   but the machine may not be idle) and write results back in place. Each
+   worker uses its own copy of the Montgomery context / private key, indexed
+   by worker id, so nothing is shared on the hot path.
+*/
+static const size_t RSA_BULK_CHUNK = 4;
+
+class RsaWorkerPool {
+public:
+    using Job = function<void(unsigned worker, size_t begin, size_t end)>;
+
+    // 0 = one worker per hardware thread.
+    explicit RsaWorkerPool(unsigned threads = 0){
+        if(threads == 0) threads = max(1u, thread::hardware_concurrency());
+        for(unsigned i = 0; i < threads; ++i) workers.emplace_back([this, i]{ workerLoop(i); });
+    }
+    ~RsaWorkerPool(){
+        {
+            lock_guard<mutex> lock(m);
+            stopping = true;
+        }
+        wake.notify_all();
+        for(auto& w : workers) w.join();
+    }
+    RsaWorkerPool(const RsaWorkerPool&) = delete;
+    RsaWorkerPool& operator=(const RsaWorkerPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+
+    // Calls job(worker, begin, end) over [0, count) in chunks and returns once
+    // all are done; the first exception thrown by a job is rethrown here.
+    void run(size_t count, size_t chunk, const Job& job){
+        if(count == 0) return;
+        lock_guard<mutex> serial(runMutex);   // one bulk job at a time
+        {
+            lock_guard<mutex> lock(m);
+            current = &job;
+            total = count;
+            chunkSize = max<size_t>(1, chunk);
+            next = 0;
+            active = size();
+            error = nullptr;
+            ++generation;
+        }
+        wake.notify_all();
+        unique_lock<mutex> lock(m);
+        done.wait(lock, [&]{ return active == 0; });
+        if(error) rethrow_exception(error);
+    }
+
+    // Process-wide pool with one worker per hardware thread.
+    static RsaWorkerPool& shared(){
+        static RsaWorkerPool pool;
+        return pool;
+    }
+
+private:
+    void workerLoop(unsigned id){
+        uint64_t seen = 0;
+        for(;;){
+            {
+                unique_lock<mutex> lock(m);
+                wake.wait(lock, [&]{ return stopping || generation != seen; });
+                if(stopping) return;
+                seen = generation;
+            }
+            for(size_t begin; (begin = next.fetch_add(chunkSize)) < total;){
+                try{
+                    (*current)(id, begin, min(total, begin + chunkSize));
+                } catch(...){
+                    lock_guard<mutex> lock(m);
+                    if(!error) error = current_exception();
+                }
+            }
+            lock_guard<mutex> lock(m);
+            if(--active == 0) done.notify_one();
+        }
+    }
+
+    vector<thread> workers;
+    mutex m, runMutex;
+    condition_variable wake, done;
+    const Job* current = nullptr;
+    size_t total = 0, chunkSize = 1;
+    atomic<size_t> next{0};
+    unsigned active = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+    exception_ptr error;
+};
+
+// blocks[i] = blocks[i]^e mod n for every block, in place.
+template<size_t L>
+void rsaEncryptBulk(vector<BigUInt<L>>& blocks, const BigUInt<L>& e, const BigUInt<L>& n,
+                    RsaWorkerPool& pool = RsaWorkerPool::shared()){
+    vector<Montgomery<L>> contexts(pool.size(), Montgomery<L>(n));
+    pool.run(blocks.size(), RSA_BULK_CHUNK, [&](unsigned w, size_t begin, size_t end){
+        for(size_t i = begin; i < end; ++i) blocks[i] = contexts[w].pow(blocks[i], e);
+    });
+}
+
+// blocks[i] = blocks[i]^d mod n (via CRT) for every block, in place.
+template<size_t L>
+void rsaDecryptBulk(vector<BigUInt<L>>& blocks, const RsaPrivateKey<L>& key,
+                    RsaWorkerPool& pool = RsaWorkerPool::shared()){
+    vector<RsaPrivateKey<L>> keys(pool.size(), key);
+    pool.run(blocks.size(), RSA_BULK_CHUNK, [&](unsigned w, size_t begin, size_t end){
+        for(size_t i = begin; i < end; ++i) blocks[i] = keys[w].pow(blocks[i]);
+    });
+}
+
+// Packed-mode message helpers on top of the bulk calls.
+template<size_t L>
+static vector<BigUInt<L>> rsaEncryptPackedParallel(const string& msg, const BigUInt<L>& e, const BigUInt<L>& n,
+                                                   EncodeMode &mode, RsaWorkerPool& pool = RsaWorkerPool::shared()){
+    vector<BigUInt<L>> blocks = rsaEncryptPackedBlocks(msg, n, mode, [](const BigUInt<L>& m){ return m; });
+    rsaEncryptBulk(blocks, e, n, pool);
+    return blocks;
+}
+
+template<size_t L>
+static string rsaDecryptMessageParallel(const vector<BigUInt<L>>& cipher, const RsaPrivateKey<L> &key,
+                                        const EncodeMode &mode, RsaWorkerPool& pool = RsaWorkerPool::shared()){
+    vector<BigUInt<L>> blocks = cipher;
+    rsaDecryptBulk(blocks, key, pool);
+    return rsaDecryptBlocks(blocks, mode, [](const BigUInt<L>& m){ return m; });
+}
+
+/* ---------- Random key generation ----------
+   Primes of the requested size come from an incremental sieve: a random odd
+   start is reduced once modulo every prime below SMALL_PRIME_LIMIT, and the
+   candidates start, start + 2, ... are skipped while any residue hits zero.
+   Survivors (about one in eight) go to Miller-Rabin with random bases in a
+   single Montgomery context. std::mt19937_64 is fine for coursework but is
+   not a cryptographic generator.
+*/
+static const uint32_t SMALL_PRIME_LIMIT = 8192;
+
+static const vector<uint32_t>& smallPrimes(){
+    static const vector<uint32_t> primes = []{
+        vector<bool> composite(SMALL_PRIME_LIMIT, false);
+        vector<uint32_t> list;
+        for(uint32_t i = 2; i < SMALL_PRIME_LIMIT; ++i){
+            if(composite[i]) continue;
+            list.push_back(i);
+            for(uint32_t j = i * i; j < SMALL_PRIME_LIMIT; j += i) composite[j] = true;
+        }
+        return list;
+    }();
+    return primes;
+}
+
+// Rounds for a 2^-80 error bound on random candidates (as OpenSSL's
+// BN_prime_checks_for_size); fewer are needed as the size grows.
+static int millerRabinRounds(size_t bits){
+    return bits >= 1300 ? 2 : bits >= 850 ? 3 : bits >= 650 ? 4 : bits >= 350 ? 8 : bits >= 250 ? 12 : 27;
+}
+
+template<size_t K>
+static BigUInt<K> randomBelow(const BigUInt<K>& bound, mt19937_64& rng){
+    BigUInt<K> r;
+    for(auto& w : r.limb) w = rng();
+    return r % bound;
+}
+
+template<size_t K>
+bool isProbablePrime(const BigUInt<K>& n, int rounds, mt19937_64& rng){
+    if(n < BigUInt<K>(2)) return false;
+    for(uint32_t sp : smallPrimes()){
+        if(n == BigUInt<K>(sp)) return true;
+        if(n.modSmall(sp) == 0) return false;
+    }
+    BigUInt<K> n1 = n - BigUInt<K>(1);
+    size_t s = 0;
+    while(!n1.bit(s)) ++s;
+    BigUInt<K> d = n1 >> s;
+    Montgomery<K> mont(n);
+    BigUInt<K> one = mont.one(), minusOne = n - one;   // 1 and n-1 in Montgomery form
+    for(int i = 0; i < rounds; ++i){
+        BigUInt<K> a = randomBelow(n - BigUInt<K>(3), rng) + BigUInt<K>(2);
+        BigUInt<K> x = mont.toMont(mont.pow(a, d));
+        if(x == one || x == minusOne) continue;
+        size_t r = 1;
+        for(; r < s; ++r){
+            x = mont.mul(x, x);
+            if(x == minusOne) break;
+        }
+        if(r == s) return false;
+    }
+    return true;
+}
+
+// Random prime of exactly `bits` bits with the top two bits set (so the
+// product of two such primes has the full size) and gcd(e, p - 1) = 1.
+// `tested` counts the candidates that reached Miller-Rabin.
+template<size_t K>
+static BigUInt<K> randomPrime(size_t bits, uint64_t e, mt19937_64& rng, size_t& tested){
+    const vector<uint32_t>& all = smallPrimes();
+    // Sieve only with primes below every candidate, so a zero residue always
+    // means a proper factor (matters for tiny test keys).
+    vector<uint32_t> primes;
+    for(uint32_t sp : all)
+        if(bits > 33 || sp < (1ull << (bits - 2))) primes.push_back(sp);
+    vector<uint32_t> residues(primes.size());
+    const uint32_t SPAN = 1 << 16;
+    for(;;){
+        BigUInt<K> start;
+        for(auto& w : start.limb) w = rng();
+        start >>= 64 * K - bits;
+        start.setBit(bits - 1);
+        start.setBit(bits - 2);
+        start.limb[0] |= 1;
+        for(size_t i = 1; i < primes.size(); ++i) residues[i] = start.modSmall(primes[i]);
+
+        for(uint32_t delta = 0; delta < SPAN; delta += 2){
+            bool composite = false;
+            for(size_t i = 1; i < primes.size() && !composite; ++i)
+                composite = (residues[i] + delta) % primes[i] == 0;
+            if(composite) continue;
+            BigUInt<K> candidate = start + BigUInt<K>(delta);
+            if(candidate.bitLength() != bits) break;
+            ++tested;
+            if((candidate - BigUInt<K>(1)).modSmall(e) == 0) continue;
+            if(isProbablePrime(candidate, millerRabinRounds(bits), rng)) return candidate;
+        }
+    }
+}
+
+// Fresh key with a `bits`-bit modulus (16 <= bits <= 64 * L) and public
+// exponent e (an odd prime, 65537 by default).
+template<size_t L>
+RsaPrivateKey<L> generateRsaKey(size_t bits, mt19937_64& rng, uint64_t e = 65537, size_t* tested = nullptr){
+    if(bits < 16 || bits > 64 * L) throw runtime_error("Key size out of range.");
+    size_t count = 0;
+    BigUInt<L / 2> p = randomPrime<L / 2>((bits + 1) / 2, e, rng, count), q;
+    do q = randomPrime<L / 2>(bits / 2, e, rng, count); while(q == p);
+    if(tested) *tested = count;
+    return RsaPrivateKey<L>(p, q, BigUInt<L>(e));
+}
+
+// Define CNS_NO_MAIN to reuse the functions above from another program
+// (see Benchmark.cpp).
+#ifndef CNS_NO_MAIN
+static double msSince(chrono::steady_clock::time_point start){
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+template<size_t L>
+static int generatedKeyDemo(size_t bits){
+    mt19937_64 rng(random_device{}());
+    size_t tested = 0;
+    auto start = chrono::steady_clock::now();
+    RsaPrivateKey<L> key = generateRsaKey<L>(bits, rng, 65537, &tested);
+    double keygenMs = msSince(start);
+    BigUInt<L> e(65537);
+
+    cout << "Public key (e, n): (" << e.toString() << ", " << key.n.toString() << ")\n";
+    cout << "Private key (d, n): (" << key.d.toString() << ", " << key.n.toString() << ")\n";
+    cout << "p = " << key.p.toString() << "\nq = " << key.q.toString() << "\n";
+    cout << "Generated a " << key.n.bitLength() << "-bit key in " << keygenMs << " ms ("
+         << tested << " candidates reached Miller-Rabin)\n";
+
+    cin.ignore(numeric_limits<streamsize>::max(), '\n');
+    string message;
+    cout << "Enter message (ASCII): ";
+    getline(cin, message);
+
+    EncodeMode mode;
+    start = chrono::steady_clock::now();
+    vector<BigUInt<L>> cipher = rsaEncryptPackedParallel(message, e, key.n, mode);
+    double encMs = msSince(start);
+    cout << "[Packed mode] " << mode.bytesPerBlock << " bytes per block\n";
+    cout << "Encrypted " << cipher.size() << " blocks in " << encMs << " ms";
+    if(!cipher.empty()) cout << "; first block: " << cipher[0].toString();
+    cout << "\n";
+
+    try{
+        start = chrono::steady_clock::now();
+        string recovered = rsaDecryptMessageParallel(cipher, key, mode);
+        double decMs = msSince(start);
+        cout << "Decrypted message (CRT, " << RsaWorkerPool::shared().size() << " workers, " << decMs << " ms, "
+             << (decMs > 0 ? cipher.size() * 1000.0 / decMs : 0.0) << " blocks/s): " << recovered << "\n";
+    } catch(const exception &ex){
+        cout << "Decryption error: " << ex.what() << "\n";
+    }
+    return 0;
+}
+
 int main(){
+    int choice;
+    cout << "1. Enter primes p and q\n2. Generate a random key of a given size\nChoice: ";
+    if(!(cin >> choice)){ return 0; }
+    if(choice == 2){
+        size_t bits;
+        cout << "Modulus size in bits (16-4096): ";
+        if(!(cin >> bits)){ return 0; }
+        try{
+            if(bits <= 512) return generatedKeyDemo<8>(bits);
+            if(bits <= 1024) return generatedKeyDemo<16>(bits);
+            if(bits <= 2048) return generatedKeyDemo<32>(bits);
+            return generatedKeyDemo<64>(bits);
+        } catch(const exception &ex){
+            cout << "Key generation failed: " << ex.what() << "\n";
+            return 0;
+        }
+    }
+
     long long p, q;
     // Enforce primality of p
     while(true){
@@ -157,8 +807,10 @@ int main(){
     while(true){
         cout << "Enter prime q: ";
         if(!(cin >> q)){ return 0; }
-        if(isPrime(q) && q != p) break;
+        bool fits = (__int128)p * q <= numeric_limits<long long>::max();
+        if(isPrime(q) && q != p && fits) break;
         if(q == p) cout << "q must differ from p.\n";
+        else if(!fits) cout << "p * q does not fit in 63 bits; generate a key instead.\n";
         else cout << "q is not prime. Try again.\n";
     }
 
@@ -180,6 +832,8 @@ int main(){
 
     cout << "Public key (e, n): (" << e << ", " << n << ")\n";
     cout << "Private key (d, n): (" << d << ", " << n << ")\n";
+    CrtKey crt = makeCrtKey(p, q, d);
+    cout << "CRT (dp, dq, qInv): (" << crt.dp << ", " << crt.dq << ", " << crt.qInv << ")\n";
 
     cin.ignore(numeric_limits<streamsize>::max(), '\n');
     string message;
@@ -201,10 +855,11 @@ int main(){
     cout << "\n";
 
     try{
-        string recovered = rsaDecryptMessage(cipher, d, n, mode);
+        string recovered = rsaDecryptMessage(cipher, crt, mode);
         cout << "Decrypted message: " << recovered << "\n";
     } catch(const exception &ex){
         cout << "Decryption error: " << ex.what() << "\n";
     }
     return 0;
-}
\ No newline at end of file
+}
+#endif
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Round-trip checks for CipherPipe: each chain must decipher back to its input
+# (up to the spaces padding the last transposition record), and chains whose
+# records cannot line up on -d must be refused.
+#
+# Usage: sh test_cipherpipe.sh [PATH_TO_CIPHERPIPE]   (default: builds a temporary one)
+
+set -u
+cd "$(dirname "$0")"
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+PIPE=${1:-$TMP/CipherPipe}
+if [ $# -eq 0 ]; then
+    g++ -O2 -std=c++17 -pthread CipherPipe.cpp -o "$PIPE" || exit 1
+fi
+fail=0
+
+# 12002 letters: an even Hill length that leaves a short final 4K record.
+i=0
+while [ $i -lt 12002 ]; do printf 'THEQUICKBROWNFOXJUMPSOVERTHELAZYDOG'; i=$((i + 35)); done | head -c 12002 > "$TMP/letters"
+
+roundtrip() {
+    "$PIPE" --block 4K "$@" < "$TMP/letters" > "$TMP/enc" &&
+    "$PIPE" -d --block 4K "$@" < "$TMP/enc" > "$TMP/dec" &&
+    head -c 12002 "$TMP/dec" | cmp -s - "$TMP/letters"
+}
+
+for chain in "caesar:-3 vigenere:LEMON" "affine:5,8 columnar:3,1,2 double:2,3,1" \
+             "hill:3,3,2,5 columnar:3,1,2" "railfence:3 railfence:5,2"; do
+    if roundtrip $chain; then echo "ok      $chain"; else echo "FAILED  $chain"; fail=1; fi
+done
+
+for chain in "columnar:3,1,2 hill:3,3,2,5" "railfence:3 columnar:3,1,4,2"; do
+    if "$PIPE" --block 4K $chain < "$TMP/letters" > /dev/null 2>&1; then
+        echo "FAILED  $chain (should be rejected)"; fail=1
+    else
+        echo "ok      $chain (rejected)"
+    fi
+done
+exit $fail